@@ -13,6 +13,31 @@
 
 unsigned char ADXL345Buffer[6];
 
+#if I2CDEVICE_USE_CACHE
+/**Shadows of the configuration registers, THRESH_TAP to TAP_AXES, BW_RATE to
+ INT_MAP and DATA_FORMAT. ACT_TAP_STATUS and INT_SOURCE are read only and
+ cleared by their reads, they are never cached.*/
+I2CDEVICE_CACHE(ADXL345TapCache, ADXL345_RA_THRESH_TAP, ADXL345_RA_TAP_AXES);
+I2CDEVICE_CACHE(ADXL345ControlCache, ADXL345_RA_BW_RATE, ADXL345_RA_INT_MAP);
+I2CDEVICE_CACHE(ADXL345FormatCache, ADXL345_RA_DATA_FORMAT,
+                ADXL345_RA_DATA_FORMAT);
+#endif
+
+/**Settings of ADXL345Initialize: measure with auto sleep, full resolution and
+ +-16g.*/
+static const tI2CRegisterSetting ADXL345InitSequence[] = {
+    {ADXL345_RA_POWER_CTL, 0xFF,
+        (1 << ADXL345_PCTL_AUTOSLEEP_BIT) | (1 << ADXL345_PCTL_MEASURE_BIT)},
+    {ADXL345_RA_DATA_FORMAT,
+        (1 << ADXL345_FORMAT_FULL_RES_BIT)
+        | I2CDEVICE_BITS_MASK(ADXL345_FORMAT_RANGE_BIT,
+                              ADXL345_FORMAT_RANGE_LENGTH),
+        (1 << ADXL345_FORMAT_FULL_RES_BIT)
+        | I2CDEVICE_BITS(ADXL345_FORMAT_RANGE_BIT,
+                         ADXL345_FORMAT_RANGE_LENGTH,
+                         ADXL345_RANGE_16G)}
+};
+
 /**
  * Power on and prepare for general usage.
  * This will activate the accelerometer, so be sure to adjust the power settings
@@ -21,12 +46,15 @@ unsigned char ADXL345Buffer[6];
  */
 void ADXL345Initialize(void)
 {
-    // reset all power settings
-    I2CDeviceWriteByte(ADXL345_RA_POWER_CTL, 0);
-    ADXL345SetAutoSleepEnabled(true);
-    ADXL345SetMeasureEnabled(true);
-    ADXL345SetFullResolution(1);
-    ADXL345SetRange(ADXL345_RANGE_16G);
+#if I2CDEVICE_USE_CACHE
+    I2CDeviceCacheAttach(&ADXL345TapCache);
+    I2CDeviceCacheAttach(&ADXL345ControlCache);
+    I2CDeviceCacheAttach(&ADXL345FormatCache);
+#endif
+
+    I2CDeviceWriteSequence(ADXL345InitSequence,
+                           sizeof (ADXL345InitSequence)
+                           / sizeof (ADXL345InitSequence[0]));
 }
 
 /**
@@ -109,3 +109,108 @@ bool DS18B20GetTemperature(tLaseredROMCode *device, float *temperature)
         return true;
     }
 }
+
+/**
+ * Starts a temperature conversion on all the sensors of the bus at once, with
+ * a Skip ROM. The sensors have to be powered (not parasite) to be polled
+ * with DS18B20IsConversionDone.
+ * @return false if no device answered the reset.
+ */
+bool DS18B20ConvertAll(void)
+{
+    if (OneWireReset() == 0)
+        return false;
+
+    OneWireSkip();
+    OneWireWrite(CONVERT_TEMPERATURE);
+
+    return true;
+}
+
+/**
+ * Checks the end of the conversions with one read slot, the sensors hold
+ * the bus low while any of them is converting.
+ * @return true when all the conversions ended.
+ */
+bool DS18B20IsConversionDone(void)
+{
+    return OneWireReadBit() != 0;
+}
+
+/**
+ * Reads the scratchpads of a table of sensors one after the other, after a
+ * DS18B20ConvertAll.
+ * @param devices ROM codes, e.g. from OneWireFindAllDevicesOnBus. The
+ *                devices of other families are skipped.
+ * @param number Number of ROM codes.
+ * @param readings Table filled with the ROM code and the temperature of each
+ *                 device, in the same order.
+ * @return Number of valid readings.
+ */
+unsigned char DS18B20ReadAll(tLaseredROMCode *devices, unsigned char number,
+                             tDS18B20Reading *readings)
+{
+    unsigned char i;
+    unsigned char valid = 0;
+    unsigned char Data[9];
+    int16_t raw;
+
+    //all the entries are set, even if the bus stops answering
+    for (i = 0; i < number; i++)
+    {
+        readings[i].rom = devices[i];
+        readings[i].valid = false;
+    }
+
+    for (i = 0; i < number; i++)
+    {
+        if (devices[i].FamilyCode != DS18B20_FAMILY_CODE)
+            continue;
+
+        if (OneWireReset() == 0)
+            break;
+
+        OneWireSelect(&devices[i]);
+        OneWireWrite(READ_SCRATCHPAD);
+        OneWireReadBytes(Data, 9);
+
+        if (Data[8] != OneWireCRC8(&Data[0], 8))
+            continue;
+
+        raw = (int16_t) (((uint16_t) Data[1] << 8) | Data[0]);
+        readings[i].temperature = raw * 0.0625;
+        readings[i].valid = true;
+        valid++;
+    }
+
+    return valid;
+}
+
+/**
+ * Gets the temperature of all the sensors of the bus: one conversion for all,
+ * polled until it ends instead of waiting the worst case, then one sweep of
+ * scratchpad reads. 20 sensors take one conversion time instead of 20.
+ * @param devices ROM codes, e.g. from OneWireFindAllDevicesOnBus.
+ * @param number Number of ROM codes.
+ * @param readings Table filled with the results, see DS18B20ReadAll.
+ * @return Number of valid readings.
+ * @warning Blocks during the conversion, from a task use DS18B20ConvertAll,
+ *          poll DS18B20IsConversionDone on the next runs and then call
+ *          DS18B20ReadAll.
+ */
+unsigned char DS18B20AcquireAll(tLaseredROMCode *devices, unsigned char number,
+                                tDS18B20Reading *readings)
+{
+    unsigned int polls = DS18B20_CONVERSION_POLLS;
+
+    if (!DS18B20ConvertAll())
+        return 0;
+
+    while (!DS18B20IsConversionDone())
+    {
+        if (--polls == 0)
+            return 0;
+    }
+
+    return DS18B20ReadAll(devices, number, readings);
+}
@@ -59,8 +59,43 @@ typedef enum
 } DS18B20Resolution;
 
 
+/**
+ * @def     DS18B20_FAMILY_CODE
+ * @brief   Family code of the ROM of the DS18B20.
+ */
+#define DS18B20_FAMILY_CODE     0x28
+
+/**
+ * @def     DS18B20_CONVERSION_POLLS
+ * @brief   Read slots to wait for the end of a conversion, a bit more than
+ *          750 ms at about 66 us per slot.
+ */
+#ifndef DS18B20_CONVERSION_POLLS
+#define DS18B20_CONVERSION_POLLS    12000
+#endif
+
+/**
+ * @struct  tDS18B20Reading
+ * @brief   Temperature of one sensor of the bus, see DS18B20ReadAll.
+ */
+typedef struct
+{
+    /** ROM code of the sensor*/
+    tLaseredROMCode rom;
+    /** Temperature in degrees*/
+    float temperature;
+    /** The scratchpad was read and its CRC is right*/
+    bool valid;
+} tDS18B20Reading;
+
 bool DS18B20Configure(tLaseredROMCode *device, DS18B20Resolution resolution);
 bool DS18B20IssueTemperatureConvertion(tLaseredROMCode *device);
 bool DS18B20GetTemperature(tLaseredROMCode *device, float *temperature);
+bool DS18B20ConvertAll(void);
+bool DS18B20IsConversionDone(void);
+unsigned char DS18B20ReadAll(tLaseredROMCode *devices, unsigned char number,
+                             tDS18B20Reading *readings);
+unsigned char DS18B20AcquireAll(tLaseredROMCode *devices, unsigned char number,
+                                tDS18B20Reading *readings);
 
 #endif
\ No newline at end of file
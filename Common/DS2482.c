@@ -28,6 +28,9 @@ unsigned char LastDiscrepancy;
 unsigned char LastFamilyDiscrepancy;
 unsigned char LastDeviceFlag;
 
+/**Last configuration written, to change the speed without the other bits*/
+static unsigned char configuration = 0;
+
 unsigned char DS2482Reset(void)
 {
     unsigned char status;
@@ -76,9 +79,12 @@ unsigned char DS2482WriteConfig(unsigned char config)
     if (config != read_config)
     {
         DS2482Reset();
+        configuration = 0;
         return false;
     }
 
+    configuration = config;
+
     return true;
 
 }
@@ -361,25 +367,6 @@ unsigned char OneWireTouchByte(unsigned char sendbyte)
     }
 }
 
-unsigned char OneWireCRC8(unsigned char *addr, unsigned char len)
-{
-    unsigned char crc = 0;
-    unsigned char i;
-
-    while (len--)
-    {
-        unsigned char inbyte = *addr++;
-        for (i = 8; i; i--)
-        {
-            unsigned char mix = (crc ^ inbyte) & 0x01;
-            crc >>= 1;
-            if (mix) crc ^= 0x8C;
-            inbyte >>= 1;
-        }
-    }
-    return crc;
-}
-
 /**
  * Find the 'first' devices on the 1-Wire network
  * @retval true device found, ROM number in ROM_NO buffer
@@ -587,3 +574,71 @@ void OneWireFindAllDevicesOnBus(tLaseredROMCode *romcode, unsigned char *num_dev
 
     *num_devices = devNum;
 }
+
+/**
+ * Sets the speed of the 1-Wire slots with the 1WS bit of the configuration,
+ * the other bits are kept. A standard speed reset puts all the devices back
+ * to standard speed.
+ * @param speed ONEWIRE_SPEED_STANDARD or ONEWIRE_SPEED_OVERDRIVE.
+ * @return The configuration was written.
+ */
+unsigned char OneWireSpeed(unsigned char speed)
+{
+    unsigned char config = configuration & ~DS2482_CFG_1WS;
+
+    if (speed == ONEWIRE_SPEED_OVERDRIVE)
+        config |= DS2482_CFG_1WS;
+
+    return DS2482WriteConfig(config);
+}
+
+/**
+ * Puts all the devices that support it in overdrive: standard speed reset and
+ * Overdrive Skip ROM, then the DS2482 goes to overdrive. The following
+ * resets and commands, e.g. a Match ROM of DS2438Configure, run at overdrive
+ * speed.
+ * @return true if a device answered the reset.
+ */
+unsigned char OneWireOverdriveSkip(void)
+{
+    if (!OneWireSpeed(ONEWIRE_SPEED_STANDARD))
+        return false;
+
+    if (!OneWireReset())
+        return false;
+
+    OneWireWriteByte(OVERDRIVE_SKIP_ROM_COMMAND);
+
+    return OneWireSpeed(ONEWIRE_SPEED_OVERDRIVE);
+}
+
+/**
+ * Puts one device in overdrive and selects it, the ROM code is sent at
+ * overdrive speed.
+ * @param device ROM code of the device.
+ * @return true if a device answered the reset.
+ */
+unsigned char OneWireOverdriveMatch(tLaseredROMCode *device)
+{
+    if (!OneWireSpeed(ONEWIRE_SPEED_STANDARD))
+        return false;
+
+    if (!OneWireReset())
+        return false;
+
+    OneWireWriteByte(OVERDRIVE_MATCH_ROM_COMMAND);
+
+    if (!OneWireSpeed(ONEWIRE_SPEED_OVERDRIVE))
+        return false;
+
+    OneWireWriteByte(device->FamilyCode);
+    OneWireWriteByte(device->ROMCodeByte1);
+    OneWireWriteByte(device->ROMCodeByte2);
+    OneWireWriteByte(device->ROMCodeByte3);
+    OneWireWriteByte(device->ROMCodeByte4);
+    OneWireWriteByte(device->ROMCodeByte5);
+    OneWireWriteByte(device->ROMCodeByte6);
+    OneWireWriteByte(device->OWICRC);
+
+    return true;
+}
@@ -26,6 +26,7 @@
 
 #include <stdbool.h>
 #include <I2CDevice.h>
+#include "OneWireCRC.h"
 
 // constants/macros/typedefs
 #define DS2482_I2C_ADDR		0x36	//< Base I2C address of DS2482 devices
@@ -38,6 +39,12 @@
 #define READ_SCRATCHPAD         0xBE
 #define COPY_SCRATCHPAD         0x48
 #define RECALL_E_E              0xB8
+#define OVERDRIVE_SKIP_ROM_COMMAND      0x3C
+#define OVERDRIVE_MATCH_ROM_COMMAND     0x69
+
+// 1-Wire speeds, see OneWireSpeed
+#define ONEWIRE_SPEED_STANDARD  0
+#define ONEWIRE_SPEED_OVERDRIVE 1
 
 // DS2482 command defines
 #define DS2482_CMD_DRST		0xF0	//< DS2482 Device Reset
@@ -117,7 +124,9 @@ void OneWireWriteByte(unsigned char sendbyte);
 unsigned char OneWireReadByte(void);
 void OneWireBlockTransfer(unsigned char *transfer_buffer, unsigned char length);
 unsigned char OneWireTouchByte(unsigned char sendbyte);
-unsigned char OneWireCRC8(unsigned char *addr, unsigned char len);
+unsigned char OneWireSpeed(unsigned char speed);
+unsigned char OneWireOverdriveSkip(void);
+unsigned char OneWireOverdriveMatch(tLaseredROMCode *device);
 unsigned char OneWireFirst(void);
 unsigned char OneWireNext(void);
 unsigned char OneWireSearch(void);
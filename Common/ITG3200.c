@@ -10,6 +10,25 @@
 
 unsigned char ITG3200Buffer[6];
 
+#if I2CDEVICE_USE_CACHE
+/**Shadow of SMPLRT_DIV, DLPF_FS and INT_CFG. PWR_MGM is not cached, its
+ H_RESET bit clears by itself.*/
+I2CDEVICE_CACHE(ITG3200Cache, ITG3200_RA_SMPLRT_DIV, ITG3200_RA_INT_CFG);
+#endif
+
+/**Settings of ITG3200Initialize: +-2000 deg/sec and the X gyro PLL clock.*/
+static const tI2CRegisterSetting ITG3200InitSequence[] = {
+    {ITG3200_RA_DLPF_FS,
+        I2CDEVICE_BITS_MASK(ITG3200_DF_FS_SEL_BIT, ITG3200_DF_FS_SEL_LENGTH),
+        I2CDEVICE_BITS(ITG3200_DF_FS_SEL_BIT, ITG3200_DF_FS_SEL_LENGTH,
+                       ITG3200_FULLSCALE_2000)},
+    {ITG3200_RA_PWR_MGM,
+        I2CDEVICE_BITS_MASK(ITG3200_PWR_CLK_SEL_BIT,
+                            ITG3200_PWR_CLK_SEL_LENGTH),
+        I2CDEVICE_BITS(ITG3200_PWR_CLK_SEL_BIT, ITG3200_PWR_CLK_SEL_LENGTH,
+                       ITG3200_CLOCK_PLL_XGYRO)}
+};
+
 /**
  * Power on and prepare for general usage.
  * This will activate the gyroscope, so be sure to adjust the power settings
@@ -22,8 +41,13 @@ unsigned char ITG3200Buffer[6];
  */
 void ITG3200Initialize(void)
 {
-    ITG3200SetFullScaleRange(ITG3200_FULLSCALE_2000);
-    ITG3200SetClockSource(ITG3200_CLOCK_PLL_XGYRO);
+#if I2CDEVICE_USE_CACHE
+    I2CDeviceCacheAttach(&ITG3200Cache);
+#endif
+
+    I2CDeviceWriteSequence(ITG3200InitSequence,
+                           sizeof (ITG3200InitSequence)
+                           / sizeof (ITG3200InitSequence[0]));
 }
 
 /**
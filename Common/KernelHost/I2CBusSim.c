@@ -0,0 +1,249 @@
+/**
+ *  @file           I2CBusSim.c
+ *  @author         Luis Maduro
+ *  @version        1.0
+ *  @date           03/05/2013
+ *  @copyright		GNU General Public License
+ *
+ *  @brief Linux simulator of an I2C bus, see I2CBusSim.h.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "I2CBusSim.h"
+
+/**Bits of the phases on the bus*/
+#define BITS_CONDITION              1
+#define BITS_WRITE                  9
+#define BITS_RECEIVE                8
+#define BITS_ACK                    1
+
+typedef struct
+{
+    /**Address of the slave NOT SHIFTED*/
+    uint8_t address;
+    /**Registers of the slave (256)*/
+    uint8_t *registers;
+} I2CBusSimDevice;
+
+static I2CBusSimHandler interruptHandler = NULL;
+static I2CBusSimDevice devices[I2CBUSSIM_MAX_DEVICES];
+static uint8_t numberDevices;
+static I2CBusSimStatistics statistics;
+
+/**A phase is on the bus, its interrupt comes on the next step*/
+static bool pending;
+/**The next byte written is the address of a slave*/
+static bool addressPhase;
+/**The next byte written is the register pointer*/
+static bool registerPhase;
+/**Slave selected by the last address, NULL if none answered*/
+static I2CBusSimDevice *pSelected;
+/**Register pointer of the selected slave*/
+static uint8_t registerPointer;
+/**Last byte received from the slave*/
+static uint8_t received;
+/**The last byte written was not acknowledged*/
+static uint8_t nacked;
+
+/**
+ * Starts a phase on the bus.
+ * @param bits Length of the phase in clocks.
+ */
+static void I2CBusSimPhase(uint8_t bits)
+{
+    pending = true;
+    statistics.busNanoseconds += bits * (1000000000ULL / I2CBUSSIM_SPEED);
+}
+
+/**
+ * Initiates the bus, without slaves.
+ * @param handler Interrupt routine of the master driver.
+ */
+void I2CBusSimInit(I2CBusSimHandler handler)
+{
+    interruptHandler = handler;
+    numberDevices = 0;
+    pending = false;
+    pSelected = NULL;
+    I2CBusSimResetStatistics();
+}
+
+/**
+ * Adds a slave to the bus.
+ * @param address Address of the slave NOT SHIFTED.
+ * @param registers Its 256 registers, read and written by the master.
+ * @return false if the bus is full.
+ */
+bool I2CBusSimAddDevice(uint8_t address, uint8_t *registers)
+{
+    if (numberDevices == I2CBUSSIM_MAX_DEVICES)
+    {
+        return false;
+    }
+
+    devices[numberDevices].address = address;
+    devices[numberDevices].registers = registers;
+    numberDevices++;
+
+    return true;
+}
+
+/**
+ * Completes the phase on the bus and calls the interrupt handler.
+ * @return false if the bus was idle.
+ */
+bool I2CBusSimStep(void)
+{
+    if (!pending)
+    {
+        return false;
+    }
+
+    pending = false;
+    statistics.interrupts++;
+
+    if (interruptHandler != NULL)
+    {
+        interruptHandler();
+    }
+
+    return true;
+}
+
+/**
+ * Runs the bus until the master stops starting phases.
+ * @return Number of interrupts.
+ */
+uint32_t I2CBusSimRun(void)
+{
+    uint32_t steps = 0;
+
+    while (I2CBusSimStep())
+    {
+        steps++;
+    }
+
+    return steps;
+}
+
+void I2CBusSimStart(void)
+{
+    statistics.starts++;
+    addressPhase = true;
+    I2CBusSimPhase(BITS_CONDITION);
+}
+
+void I2CBusSimRestart(void)
+{
+    I2CBusSimStart();
+}
+
+void I2CBusSimStop(void)
+{
+    statistics.stops++;
+    pSelected = NULL;
+    I2CBusSimPhase(BITS_CONDITION);
+}
+
+void I2CBusSimWrite(uint8_t data)
+{
+    uint8_t index;
+
+    statistics.bytes++;
+    nacked = 1;
+
+    if (addressPhase)
+    {
+        addressPhase = false;
+        pSelected = NULL;
+
+        for (index = 0; index < numberDevices; index++)
+        {
+            if (devices[index].address == (data >> 1))
+            {
+                pSelected = &devices[index];
+                nacked = 0;
+            }
+        }
+
+        //a write starts with the register pointer
+        registerPhase = !(data & 0x01);
+    }
+    else if (pSelected != NULL)
+    {
+        if (registerPhase)
+        {
+            registerPhase = false;
+            registerPointer = data;
+        }
+        else
+        {
+            pSelected->registers[registerPointer++] = data;
+        }
+
+        nacked = 0;
+    }
+
+    if (nacked)
+    {
+        statistics.nacks++;
+    }
+
+    I2CBusSimPhase(BITS_WRITE);
+}
+
+void I2CBusSimReceive(void)
+{
+    statistics.bytes++;
+    received = (pSelected != NULL)
+            ? pSelected->registers[registerPointer++] : 0xFF;
+    I2CBusSimPhase(BITS_RECEIVE);
+}
+
+uint8_t I2CBusSimRead(void)
+{
+    return received;
+}
+
+void I2CBusSimAck(uint8_t notAck)
+{
+    (void) notAck;
+
+    I2CBusSimPhase(BITS_ACK);
+}
+
+uint8_t I2CBusSimNacked(void)
+{
+    return nacked;
+}
+
+/**
+ * Gets the counters of the bus.
+ * @return Pointer to the statistics.
+ */
+const I2CBusSimStatistics *I2CBusSimGetStatistics(void)
+{
+    return &statistics;
+}
+
+/**
+ * Clears the counters of the bus.
+ */
+void I2CBusSimResetStatistics(void)
+{
+    memset(&statistics, 0, sizeof (statistics));
+}
+
+/**
+ * Prints the counters of the bus to the standard output.
+ */
+void I2CBusSimPrintStatistics(void)
+{
+    printf("i2c transactions: %lu (%lu starts)\n",
+           (unsigned long) statistics.stops, (unsigned long) statistics.starts);
+    printf("i2c bytes: %lu (%lu not acknowledged)\n",
+           (unsigned long) statistics.bytes, (unsigned long) statistics.nacks);
+    printf("i2c interrupts: %lu\n", (unsigned long) statistics.interrupts);
+    printf("i2c bus time: %.1f us\n", statistics.busNanoseconds / 1000.0);
+}
@@ -0,0 +1,93 @@
+/**
+ *  @file           I2CBusSim.h
+ *  @author         Luis Maduro
+ *  @version        1.0
+ *  @date           03/05/2013
+ *  @copyright		GNU General Public License
+ *
+ *  @brief Linux simulator of an I2C bus, an MSSP master and register based
+ *  slaves (auto increment of the register pointer, like the ADXL345, ITG3200,
+ *  MPU9150...).
+ *  Each phase started by the master (start, byte, ack, stop...) completes on
+ *  the next I2CBusSimStep(), which then calls the interrupt handler, as the
+ *  MSSP interrupt would. The bus time of each phase is counted at
+ *  I2CBUSSIM_SPEED, e.g.:
+ *  @code
+ *  gcc -DI2CASYNC_HOST main.c PIC18F/I2CAsync.c Common/KernelHost/I2CBusSim.c
+ *  @endcode
+ *  and in main():
+ *  @code
+ *  I2CBusSimInit(I2CAsyncInterruptHandler);
+ *  I2CBusSimAddDevice(0x53, adxl345Registers);
+ *  I2CAsyncInit();
+ *  I2CAsyncRead(&transaction, 0x53, 0x32, 6, data, Done);
+ *  while (I2CBusSimStep())
+ *  {
+ *      //computation overlapped with the bus
+ *  }
+ *  @endcode
+ */
+
+#ifndef I2CBUSSIM_H
+#define	I2CBUSSIM_H
+
+#ifdef	__cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**Number of slaves on the bus.*/
+#ifndef I2CBUSSIM_MAX_DEVICES
+#define I2CBUSSIM_MAX_DEVICES       4
+#endif
+
+/**Clock of the bus in Hz.*/
+#ifndef I2CBUSSIM_SPEED
+#define I2CBUSSIM_SPEED             400000UL
+#endif
+
+/**Interrupt routine of the master driver.*/
+typedef void (*I2CBusSimHandler)(void);
+
+typedef struct
+{
+    /**Interrupts raised (phases completed)*/
+    uint32_t interrupts;
+    /**Start and restart conditions*/
+    uint32_t starts;
+    /**Stop conditions*/
+    uint32_t stops;
+    /**Bytes written and read, addresses included*/
+    uint32_t bytes;
+    /**Bytes not acknowledged by a slave*/
+    uint32_t nacks;
+    /**Time the bus was busy in nanoseconds*/
+    uint64_t busNanoseconds;
+} I2CBusSimStatistics;
+
+void I2CBusSimInit(I2CBusSimHandler handler);
+bool I2CBusSimAddDevice(uint8_t address, uint8_t *registers);
+bool I2CBusSimStep(void);
+uint32_t I2CBusSimRun(void);
+const I2CBusSimStatistics *I2CBusSimGetStatistics(void);
+void I2CBusSimResetStatistics(void);
+void I2CBusSimPrintStatistics(void);
+
+/**The hardware of the master, used through the I2CASYNC_* macros.*/
+void I2CBusSimStart(void);
+void I2CBusSimRestart(void);
+void I2CBusSimStop(void);
+void I2CBusSimWrite(uint8_t data);
+void I2CBusSimReceive(void);
+uint8_t I2CBusSimRead(void);
+void I2CBusSimAck(uint8_t notAck);
+uint8_t I2CBusSimNacked(void);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* I2CBUSSIM_H */
@@ -0,0 +1,284 @@
+/**
+ *  @file           KernelHost.c
+ *  @author         Luis Maduro
+ *  @version        1.0
+ *  @date           03/05/2013
+ *  @copyright		GNU General Public License
+ *
+ *  @brief Linux port of the schedulers (uKernel, pKernel and Tasker) with a
+ *  virtual millisecond clock.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "KernelHost.h"
+
+static KernelHostSchedulerPass pass = NULL;
+static KernelHostTickHook hook = NULL;
+/**Microseconds elapsed inside the current millisecond*/
+static uint32_t subMicroseconds;
+static KernelHostStatistics statistics;
+/**End of KernelHostRunFor, an overloaded task set must not run past it*/
+static uint32_t runEnd;
+static bool runLimited = false;
+
+/**
+ * Initiates the simulation with the scheduler to be run. The clock starts at 0.
+ * @param schedulerPass Rotation function of the scheduler, i.e.
+ *                      uKernelSchedulerPass, pKernelSchedulerPass or
+ *                      TaskerSchedulerPass.
+ */
+void KernelHostInit(KernelHostSchedulerPass schedulerPass)
+{
+    pass = schedulerPass;
+    hook = NULL;
+    KernelHostSetTime(0);
+    KernelHostResetStatistics();
+}
+
+/**
+ * Sets a function to be called on every tick, like a timer interrupt would.
+ * Useful to simulate interrupts posting to the tasks.
+ * @param tickHook Function to be called, NULL to remove.
+ */
+void KernelHostSetTickHook(KernelHostTickHook tickHook)
+{
+    hook = tickHook;
+}
+
+/**
+ * Sets the virtual clock. Use values close to 2^32 to test the wraparound.
+ * @param milliseconds New value of _counterMs.
+ */
+void KernelHostSetTime(uint32_t milliseconds)
+{
+    _counterMs = milliseconds;
+    subMicroseconds = 0;
+}
+
+/**
+ * Called by the tasks to tell how long they take to run. The clock moves
+ * forward, as the timer interrupt would while the task is running.
+ * @param microseconds Execution time of the task.
+ */
+void KernelHostConsume(uint32_t microseconds)
+{
+    statistics.busyMicroseconds += microseconds;
+    statistics.elapsedMicroseconds += microseconds;
+
+    subMicroseconds += microseconds;
+
+    while (subMicroseconds >= 1000)
+    {
+        subMicroseconds -= 1000;
+        uKernelTimerInterruptHandler();
+        statistics.ticks++;
+        if (hook != NULL)
+        {
+            hook();
+        }
+    }
+}
+
+/**
+ * Idle hook of the schedulers on the host (UKERNEL_IDLE). The clock moves to
+ * the next tick, so uKernelSleep and uKernelScheduler also work here.
+ * @param milliseconds Time the scheduler could sleep, not used.
+ */
+void KernelHostIdle(uint32_t milliseconds)
+{
+    (void) milliseconds;
+
+    statistics.elapsedMicroseconds += 1000 - subMicroseconds;
+    subMicroseconds = 0;
+    uKernelTimerInterruptHandler();
+    statistics.ticks++;
+    if (hook != NULL)
+    {
+        hook();
+    }
+}
+
+/**
+ * Count of the virtual tick timer (UKERNEL_TIMER_COUNT), the microseconds
+ * elapsed since the last tick.
+ * @return Microseconds inside the current millisecond.
+ */
+uint32_t KernelHostGetTimerCount(void)
+{
+    return subMicroseconds;
+}
+
+/**
+ * Runs the scheduler without moving the clock until a rotation executes no
+ * task.
+ * @return Number of tasks executed.
+ */
+uint32_t KernelHostRunUntilIdle(void)
+{
+    uint32_t rotations;
+    uint32_t executed;
+    uint32_t total = 0;
+
+    if (pass == NULL)
+    {
+        return 0;
+    }
+
+    for (rotations = 0; rotations < KERNELHOST_MAX_ROTATIONS; rotations++)
+    {
+        executed = pass();
+        statistics.rotations++;
+
+        if (executed == 0)
+        {
+            statistics.idleRotations++;
+            return total;
+        }
+
+        //the first work of this tick woke the CPU
+        if (total == 0)
+        {
+            statistics.wakeups++;
+        }
+
+        statistics.dispatches += executed;
+        total += executed;
+
+        //the tasks took all the time that was left
+        if (runLimited && (int32_t) (runEnd - _counterMs) <= 0)
+        {
+            return total;
+        }
+    }
+
+    statistics.saturatedTicks++;
+
+    return total;
+}
+
+/**
+ * Runs the simulation for some time. On every millisecond the scheduler runs
+ * until it is idle and then the clock moves to the next millisecond.
+ * @param milliseconds Time to simulate.
+ */
+void KernelHostRunFor(uint32_t milliseconds)
+{
+    uint32_t end = _counterMs + milliseconds;
+
+    runEnd = end;
+    runLimited = true;
+
+    //this trick overrun the overflow of _counterMs
+    while ((int32_t) (end - _counterMs) > 0)
+    {
+        KernelHostRunUntilIdle();
+
+        if ((int32_t) (end - _counterMs) <= 0)
+        {
+            break;
+        }
+
+        //idle until the next tick
+        KernelHostIdle(1);
+    }
+
+    runLimited = false;
+}
+
+/**
+ * Gets the counters of the simulation.
+ * @return Pointer to the statistics.
+ */
+const KernelHostStatistics *KernelHostGetStatistics(void)
+{
+    return &statistics;
+}
+
+/**
+ * Clears the counters of the simulation.
+ */
+void KernelHostResetStatistics(void)
+{
+    memset(&statistics, 0, sizeof (statistics));
+}
+
+/**
+ * Prints the counters of the simulation to the standard output.
+ */
+void KernelHostPrintStatistics(void)
+{
+    printf("ticks: %lu\n", (unsigned long) statistics.ticks);
+    printf("rotations: %lu (%lu idle)\n", (unsigned long) statistics.rotations,
+           (unsigned long) statistics.idleRotations);
+    printf("dispatches: %lu\n", (unsigned long) statistics.dispatches);
+    printf("saturated ticks: %lu\n", (unsigned long) statistics.saturatedTicks);
+
+    if (statistics.ticks != 0)
+    {
+        printf("wakeups: %lu (%.1f per second)\n",
+               (unsigned long) statistics.wakeups,
+               1000.0 * statistics.wakeups / statistics.ticks);
+    }
+
+    if (statistics.dispatches != 0)
+    {
+        printf("rotations per dispatch: %.2f\n",
+               (double) statistics.rotations / statistics.dispatches);
+    }
+
+    if (statistics.elapsedMicroseconds != 0)
+    {
+        printf("cpu load: %.2f%%\n", 100.0 * statistics.busyMicroseconds
+               / statistics.elapsedMicroseconds);
+    }
+}
+
+#if defined(UKERNEL_HOST) && UKERNEL_USE_STATISTICS
+
+/**
+ * Called by a task to consume its declared worst case execution time, so a
+ * task set can be simulated from its periods and WCETs only.
+ */
+void KernelHostConsumeWCET(void)
+{
+#if UKERNEL_SCHEDULING_POLICY != UKERNEL_POLICY_ROUND_ROBIN
+    uKernelTaskDescriptor *pTask = uKernelGetCurrentTask();
+
+    if (pTask != NULL)
+    {
+        KernelHostConsume(pTask->wcet);
+    }
+#endif
+}
+
+/**
+ * Prints the runs and deadline misses of every task of uKernel.
+ */
+void KernelHostPrintDeadlines(void)
+{
+    uKernelTaskDescriptor *pTask = NULL;
+    uint8_t index = 0;
+
+    while ((pTask = uKernelGetNextTask(pTask)) != NULL)
+    {
+        printf("task %u: period %lu ms, releases %u, misses %u",
+               index, (unsigned long) pTask->userTasksInterval,
+               pTask->releases, pTask->deadlineMisses);
+
+        if (pTask->releases != 0)
+        {
+            printf(" (%.2f%%)", 100.0 * pTask->deadlineMisses
+                   / pTask->releases);
+        }
+
+        printf("\n");
+        index++;
+    }
+
+#if UKERNEL_SCHEDULING_POLICY != UKERNEL_POLICY_ROUND_ROBIN
+    printf("utilization: %.2f%%\n", 100.0 * uKernelGetUtilization() / 65536);
+#endif
+}
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ *  @file           KernelHost.h
+ *  @author         Luis Maduro
+ *  @version        1.0
+ *  @date           03/05/2013
+ *  @copyright		GNU General Public License
+ *
+ *  @brief Linux port of the schedulers (uKernel, pKernel and Tasker) with a
+ *  virtual millisecond clock.
+ *  Time only moves when the simulation moves it, so the same task set always
+ *  gives the same results. Tasks can tell how long they take with
+ *  KernelHostConsume() and the simulation reports the scheduler overhead.
+ *
+ *  Build it together with the scheduler core (uKernel.c), the API used by the
+ *  application (pKernel.c or Tasker.c, if any) and define the host symbol of
+ *  that API (UKERNEL_HOST, PKERNEL_HOST or TASKER_HOST), e.g.:
+ *  @code
+ *  gcc -DTASKER_HOST -ICommon/Tasker -ICommon/KernelHost main.c
+ *      Common/Tasker/Tasker.c Common/uKernel/uKernel.c
+ *      Common/KernelHost/KernelHost.c
+ *  @endcode
+ *  and in main():
+ *  @code
+ *  KernelHostInit(TaskerSchedulerPass);
+ *  KernelHostSetTime(0xFFFFFF00UL);    //test the 2^32 wraparound
+ *  TaskerBegin();
+ *  TaskerAddTask(Blink, 100, SCHEDULED);
+ *  KernelHostRunFor(1000);
+ *  KernelHostPrintStatistics();
+ *  @endcode
+ *  To check a task set under EDF or rate monotonic build with
+ *  -DUKERNEL_SCHEDULING_POLICY=UKERNEL_POLICY_EDF, add the tasks with
+ *  uKernelAddTaskWithWCET(), let each task call KernelHostConsumeWCET() and
+ *  print the miss rates with KernelHostPrintDeadlines().
+ */
+
+#ifndef KERNELHOST_H
+#define	KERNELHOST_H
+
+#ifdef	__cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../uKernel/uKernel.h"
+
+/**Maximum number of rotations on the same millisecond before the time is
+ forced to move (tasks that always yield would never let the scheduler idle).*/
+#ifndef KERNELHOST_MAX_ROTATIONS
+#define KERNELHOST_MAX_ROTATIONS    1000
+#endif
+
+/**One rotation of the scheduler, returns the number of tasks executed.*/
+typedef unsigned char (*KernelHostSchedulerPass)(void);
+
+/**Called on every millisecond tick, in place of the timer interrupt.*/
+typedef void (*KernelHostTickHook)(void);
+
+typedef struct
+{
+    /**Milliseconds ticks simulated*/
+    uint32_t ticks;
+    /**Rotations of the scheduler*/
+    uint32_t rotations;
+    /**Rotations where no task was executed*/
+    uint32_t idleRotations;
+    /**Tasks executed*/
+    uint32_t dispatches;
+    /**Ticks where the CPU left the idle to run something*/
+    uint32_t wakeups;
+    /**Milliseconds where the tasks never let the scheduler idle*/
+    uint32_t saturatedTicks;
+    /**Microseconds consumed by the tasks*/
+    uint64_t busyMicroseconds;
+    /**Microseconds simulated*/
+    uint64_t elapsedMicroseconds;
+} KernelHostStatistics;
+
+extern volatile uint32_t _counterMs;
+
+void KernelHostInit(KernelHostSchedulerPass schedulerPass);
+void KernelHostSetTickHook(KernelHostTickHook tickHook);
+void KernelHostSetTime(uint32_t milliseconds);
+void KernelHostConsume(uint32_t microseconds);
+void KernelHostIdle(uint32_t milliseconds);
+uint32_t KernelHostGetTimerCount(void);
+uint32_t KernelHostRunUntilIdle(void);
+void KernelHostRunFor(uint32_t milliseconds);
+const KernelHostStatistics *KernelHostGetStatistics(void);
+void KernelHostResetStatistics(void);
+void KernelHostPrintStatistics(void);
+#if defined(UKERNEL_HOST) && UKERNEL_USE_STATISTICS
+void KernelHostConsumeWCET(void);
+void KernelHostPrintDeadlines(void);
+#endif
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* KERNELHOST_H */
@@ -0,0 +1,628 @@
+/**
+ *  @file           OneWireBusSim.c
+ *  @author         Luis Maduro
+ *  @version        1.0
+ *  @date           03/05/2013
+ *  @copyright		GNU General Public License
+ *
+ *  @brief Linux simulator of a 1-Wire bus, see OneWireBusSim.h.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "OneWireBusSim.h"
+
+/**Shortest low pulse taken as a reset*/
+#define RESET_LOW                   480
+/**A low pulse shorter than this writes a 1*/
+#define BIT_THRESHOLD               15
+/**Time a slave holds the wire low to send a 0*/
+#define BIT_HOLD                    30
+/**Presence pulse, from the release of the reset*/
+#define PRESENCE_START              20
+#define PRESENCE_END                140
+/**The same in overdrive, the time is rounded to microseconds*/
+#define OD_RESET_LOW                48
+#define OD_BIT_THRESHOLD            3
+#define OD_BIT_HOLD                 4
+#define OD_PRESENCE_START           2
+#define OD_PRESENCE_END             10
+/**Conversion time at 12 bits*/
+#define CONVERSION_TIME             750000
+
+/**States of a slave*/
+enum
+{
+    SLAVE_IDLE,
+    SLAVE_ROM_COMMAND,
+    SLAVE_MATCH,
+    SLAVE_SEARCH,
+    SLAVE_FUNCTION,
+    SLAVE_WRITE_SCRATCHPAD,
+    SLAVE_TRANSMIT,
+    SLAVE_CONVERTING
+};
+
+typedef struct
+{
+    /**Answers on the bus*/
+    bool present;
+    uint8_t rom[8];
+    uint8_t scratchpad[9];
+    /**Temperature in 1/16 degrees, copied to the scratchpad by convert T*/
+    int16_t temperature;
+    /**Answers the alarm search*/
+    bool alarm;
+    /**Accepts the overdrive ROM commands*/
+    bool overdriveCapable;
+    /**Runs at overdrive speed, until a standard reset*/
+    bool overdrive;
+    uint8_t state;
+    /**Bits received or sent in the state*/
+    uint16_t count;
+    uint8_t buffer[9];
+    /**Bytes to send in SLAVE_TRANSMIT, ones after them*/
+    uint8_t length;
+    /**Phase of the search triplet: bit, complement, direction*/
+    uint8_t triplet;
+    /**End of the conversion*/
+    uint64_t conversionEnd;
+    /**The wire is held low until then*/
+    uint64_t holdUntil;
+} OneWireBusSimDevice;
+
+static OneWireBusSimHandler interruptHandler = NULL;
+static OneWireBusSimDevice devices[ONEWIREBUSSIM_MAX_DEVICES];
+static int numberDevices;
+static OneWireBusSimStatistics statistics;
+
+/**Virtual time in microseconds*/
+static uint64_t now;
+/**The master drives the wire low*/
+static bool masterLow;
+/**Start of the last low pulse of the master*/
+static uint64_t fallTime;
+/**End of the presence pulses*/
+static uint64_t presenceStart;
+static uint64_t presenceEnd;
+/**Timer of the master*/
+static bool timerRunning;
+static uint64_t timerStart;
+static uint64_t timerEnd;
+static uint16_t timerPeriod;
+
+static uint8_t OneWireBusSimCRC8(const uint8_t *data, uint8_t length)
+{
+    uint8_t crc = 0;
+    uint8_t i;
+
+    while (length--)
+    {
+        crc ^= *data++;
+
+        for (i = 0; i < 8; i++)
+        {
+            crc = (crc & 0x01) ? (crc >> 1) ^ 0x8C : crc >> 1;
+        }
+    }
+
+    return crc;
+}
+
+/**
+ * Initiates the bus, without slaves.
+ * @param handler Timer interrupt routine of the master driver.
+ */
+void OneWireBusSimInit(OneWireBusSimHandler handler)
+{
+    interruptHandler = handler;
+    numberDevices = 0;
+    now = 0;
+    masterLow = false;
+    presenceEnd = 0;
+    timerRunning = false;
+    OneWireBusSimResetStatistics();
+}
+
+/**
+ * Adds a slave to the bus, with the power on scratchpad of a DS18B20.
+ * @param rom Its 8 bytes ROM code, the CRC is computed if the last byte is 0.
+ * @param temperature Temperature returned by the conversions in 1/16 degrees.
+ * @return Index of the slave, -1 if the bus is full.
+ */
+int OneWireBusSimAddDevice(const uint8_t *rom, int16_t temperature)
+{
+    OneWireBusSimDevice *pDevice;
+    static const uint8_t powerOn[8] = {0x50, 0x05, 0x4B, 0x46,
+                                       0x7F, 0xFF, 0x0C, 0x10};
+
+    if (numberDevices == ONEWIREBUSSIM_MAX_DEVICES)
+    {
+        return -1;
+    }
+
+    pDevice = &devices[numberDevices];
+    memset(pDevice, 0, sizeof (*pDevice));
+    pDevice->present = true;
+    memcpy(pDevice->rom, rom, 8);
+
+    if (pDevice->rom[7] == 0)
+    {
+        pDevice->rom[7] = OneWireBusSimCRC8(pDevice->rom, 7);
+    }
+
+    memcpy(pDevice->scratchpad, powerOn, 8);
+    pDevice->scratchpad[8] = OneWireBusSimCRC8(pDevice->scratchpad, 8);
+    pDevice->temperature = temperature;
+    pDevice->state = SLAVE_IDLE;
+
+    return numberDevices++;
+}
+
+/**
+ * Connects or disconnects a slave.
+ */
+void OneWireBusSimSetPresent(int index, bool present)
+{
+    devices[index].present = present;
+    devices[index].state = SLAVE_IDLE;
+}
+
+void OneWireBusSimSetTemperature(int index, int16_t temperature)
+{
+    devices[index].temperature = temperature;
+}
+
+/**
+ * Sets the alarm flag, the slave then answers the alarm search (0xEC).
+ */
+void OneWireBusSimSetAlarm(int index, bool alarm)
+{
+    devices[index].alarm = alarm;
+}
+
+/**
+ * Lets a slave accept Overdrive Skip ROM (0x3C) and Overdrive Match ROM (0x69).
+ */
+void OneWireBusSimSetOverdriveCapable(int index, bool capable)
+{
+    devices[index].overdriveCapable = capable;
+}
+
+/**
+ * Starts sending bytes, followed by ones.
+ */
+static void OneWireBusSimTransmit(OneWireBusSimDevice *pDevice,
+                                  const uint8_t *data, uint8_t length)
+{
+    if (length != 0)
+    {
+        memcpy(pDevice->buffer, data, length);
+    }
+
+    pDevice->length = length;
+    pDevice->count = 0;
+    pDevice->state = SLAVE_TRANSMIT;
+}
+
+/**
+ * Bit that the slave puts on the next slot, 1 if it is listening.
+ */
+static uint8_t OneWireBusSimSlaveBit(OneWireBusSimDevice *pDevice)
+{
+    uint8_t bit;
+
+    switch (pDevice->state)
+    {
+        case SLAVE_TRANSMIT:
+            if (pDevice->count >= pDevice->length * 8)
+            {
+                return 1;
+            }
+            return (pDevice->buffer[pDevice->count >> 3]
+                    >> (pDevice->count & 0x07)) & 0x01;
+
+        case SLAVE_SEARCH:
+            if (pDevice->triplet == 2)
+            {
+                return 1;
+            }
+            bit = (pDevice->rom[pDevice->count >> 3]
+                   >> (pDevice->count & 0x07)) & 0x01;
+            return (pDevice->triplet == 0) ? bit : !bit;
+
+        case SLAVE_CONVERTING:
+            return now >= pDevice->conversionEnd;
+
+        default:
+            return 1;
+    }
+}
+
+/**
+ * A function command was received.
+ */
+static void OneWireBusSimFunction(OneWireBusSimDevice *pDevice, uint8_t command)
+{
+    uint32_t conversion;
+
+    pDevice->count = 0;
+
+    switch (command)
+    {
+        case 0x44:
+            //9 to 12 bits, 93.75 to 750 ms
+            conversion = CONVERSION_TIME >> (3 - ((pDevice->scratchpad[4] >> 5) & 0x03));
+            pDevice->conversionEnd = now + conversion;
+            pDevice->scratchpad[0] = (uint8_t) pDevice->temperature;
+            pDevice->scratchpad[1] = (uint8_t) (pDevice->temperature >> 8);
+            pDevice->scratchpad[8] = OneWireBusSimCRC8(pDevice->scratchpad, 8);
+            pDevice->state = SLAVE_CONVERTING;
+            break;
+
+        case 0xBE:
+            OneWireBusSimTransmit(pDevice, pDevice->scratchpad, 9);
+            break;
+
+        case 0x4E:
+            pDevice->state = SLAVE_WRITE_SCRATCHPAD;
+            break;
+
+        case 0xB4:
+            //external power supply
+            OneWireBusSimTransmit(pDevice, NULL, 0);
+            break;
+
+        default:
+            pDevice->state = SLAVE_IDLE;
+            break;
+    }
+}
+
+/**
+ * A ROM command was received.
+ */
+static void OneWireBusSimRomCommand(OneWireBusSimDevice *pDevice, uint8_t command)
+{
+    pDevice->count = 0;
+
+    switch (command)
+    {
+        case 0x33:
+            OneWireBusSimTransmit(pDevice, pDevice->rom, 8);
+            break;
+
+        case 0x55:
+            pDevice->state = SLAVE_MATCH;
+            break;
+
+        case 0xCC:
+            pDevice->state = SLAVE_FUNCTION;
+            break;
+
+        case 0x3C:
+            pDevice->overdrive = pDevice->overdriveCapable;
+            pDevice->state = pDevice->overdrive ? SLAVE_FUNCTION : SLAVE_IDLE;
+            break;
+
+        case 0x69:
+            pDevice->overdrive = pDevice->overdriveCapable;
+            pDevice->state = pDevice->overdrive ? SLAVE_MATCH : SLAVE_IDLE;
+            break;
+
+        case 0xEC:
+            if (!pDevice->alarm)
+            {
+                pDevice->state = SLAVE_IDLE;
+                break;
+            }
+            // fall through
+        case 0xF0:
+            pDevice->triplet = 0;
+            pDevice->state = SLAVE_SEARCH;
+            break;
+
+        default:
+            pDevice->state = SLAVE_IDLE;
+            break;
+    }
+}
+
+/**
+ * Receives a bit written by the master, or the end of a slot the slave
+ * answered.
+ */
+static void OneWireBusSimSlaveSlot(OneWireBusSimDevice *pDevice, uint8_t bit)
+{
+    uint8_t index;
+
+    switch (pDevice->state)
+    {
+        case SLAVE_ROM_COMMAND:
+        case SLAVE_FUNCTION:
+        case SLAVE_MATCH:
+        case SLAVE_WRITE_SCRATCHPAD:
+            index = pDevice->count >> 3;
+
+            if ((pDevice->count & 0x07) == 0)
+            {
+                pDevice->buffer[index] = 0;
+            }
+
+            pDevice->buffer[index] |= bit << (pDevice->count & 0x07);
+            pDevice->count++;
+
+            if ((pDevice->count & 0x07) != 0)
+            {
+                break;
+            }
+
+            if (pDevice->state == SLAVE_ROM_COMMAND)
+            {
+                OneWireBusSimRomCommand(pDevice, pDevice->buffer[0]);
+            }
+            else if (pDevice->state == SLAVE_FUNCTION)
+            {
+                OneWireBusSimFunction(pDevice, pDevice->buffer[0]);
+            }
+            else if ((pDevice->state == SLAVE_MATCH) && (pDevice->count == 64))
+            {
+                pDevice->count = 0;
+                pDevice->state = memcmp(pDevice->buffer, pDevice->rom, 8)
+                        ? SLAVE_IDLE : SLAVE_FUNCTION;
+            }
+            else if ((pDevice->state == SLAVE_WRITE_SCRATCHPAD)
+                    && (pDevice->count == 24))
+            {
+                memcpy(&pDevice->scratchpad[2], pDevice->buffer, 3);
+                pDevice->scratchpad[8] = OneWireBusSimCRC8(pDevice->scratchpad, 8);
+                pDevice->state = SLAVE_IDLE;
+            }
+            break;
+
+        case SLAVE_SEARCH:
+            if (pDevice->triplet < 2)
+            {
+                pDevice->triplet++;
+                break;
+            }
+
+            pDevice->triplet = 0;
+
+            if (bit != ((pDevice->rom[pDevice->count >> 3]
+                         >> (pDevice->count & 0x07)) & 0x01))
+            {
+                pDevice->state = SLAVE_IDLE;
+            }
+            else if (++pDevice->count == 64)
+            {
+                pDevice->count = 0;
+                pDevice->state = SLAVE_FUNCTION;
+            }
+            break;
+
+        case SLAVE_TRANSMIT:
+            pDevice->count++;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * Lets the time pass without the master, e.g. during a conversion.
+ * @param microseconds Time to wait.
+ */
+void OneWireBusSimWait(uint32_t microseconds)
+{
+    now += microseconds;
+}
+
+/**
+ * Completes the timer period and calls the interrupt handler.
+ * @return false if the timer was stopped.
+ */
+bool OneWireBusSimStep(void)
+{
+    if (!timerRunning)
+    {
+        return false;
+    }
+
+    timerRunning = false;
+
+    if (now < timerEnd)
+    {
+        now = timerEnd;
+    }
+
+    statistics.interrupts++;
+
+    if (interruptHandler != NULL)
+    {
+        interruptHandler();
+    }
+
+    return true;
+}
+
+/**
+ * Runs the bus until the master stops its timer.
+ * @return Number of interrupts.
+ */
+uint32_t OneWireBusSimRun(void)
+{
+    uint32_t steps = 0;
+
+    while (OneWireBusSimStep())
+    {
+        steps++;
+    }
+
+    return steps;
+}
+
+uint64_t OneWireBusSimGetTime(void)
+{
+    return now;
+}
+
+void OneWireBusSimLow(void)
+{
+    int i;
+
+    if (masterLow)
+    {
+        return;
+    }
+
+    masterLow = true;
+    fallTime = now;
+
+    for (i = 0; i < numberDevices; i++)
+    {
+        devices[i].holdUntil = (devices[i].present
+                                && !OneWireBusSimSlaveBit(&devices[i]))
+                ? now + (devices[i].overdrive ? OD_BIT_HOLD : BIT_HOLD) : 0;
+    }
+}
+
+void OneWireBusSimRelease(void)
+{
+    int i;
+    uint64_t low;
+
+    if (!masterLow)
+    {
+        return;
+    }
+
+    masterLow = false;
+    low = now - fallTime;
+
+    if (low >= RESET_LOW)
+    {
+        statistics.resets++;
+        presenceStart = now + PRESENCE_START;
+        presenceEnd = 0;
+
+        for (i = 0; i < numberDevices; i++)
+        {
+            devices[i].holdUntil = 0;
+            devices[i].overdrive = false;
+
+            if (devices[i].present)
+            {
+                devices[i].state = SLAVE_ROM_COMMAND;
+                devices[i].count = 0;
+                presenceEnd = now + PRESENCE_END;
+            }
+        }
+        return;
+    }
+
+    if (low >= OD_RESET_LOW)
+    {
+        //an overdrive reset, a long 0 for the standard speed slaves
+        presenceStart = now + OD_PRESENCE_START;
+        presenceEnd = 0;
+
+        for (i = 0; i < numberDevices; i++)
+        {
+            if (devices[i].present && devices[i].overdrive)
+            {
+                devices[i].holdUntil = 0;
+                devices[i].state = SLAVE_ROM_COMMAND;
+                devices[i].count = 0;
+                presenceEnd = now + OD_PRESENCE_END;
+            }
+        }
+
+        if (presenceEnd != 0)
+        {
+            statistics.resets++;
+        }
+    }
+    else
+    {
+        statistics.slots++;
+    }
+
+    for (i = 0; i < numberDevices; i++)
+    {
+        if (devices[i].present && !(devices[i].overdrive
+                                    && (low >= OD_RESET_LOW)))
+        {
+            OneWireBusSimSlaveSlot(&devices[i], low < (devices[i].overdrive
+                                                       ? OD_BIT_THRESHOLD
+                                                       : BIT_THRESHOLD));
+        }
+    }
+}
+
+uint8_t OneWireBusSimRead(void)
+{
+    int i;
+
+    if (masterLow || ((now >= presenceStart) && (now < presenceEnd)))
+    {
+        return 0;
+    }
+
+    for (i = 0; i < numberDevices; i++)
+    {
+        if (devices[i].holdUntil > now)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+void OneWireBusSimTimerStart(uint16_t microseconds)
+{
+    timerRunning = true;
+    timerStart = now;
+    timerPeriod = microseconds;
+    timerEnd = now + microseconds;
+}
+
+uint8_t OneWireBusSimTimerLow(void)
+{
+    now++;
+    statistics.busyMicroseconds++;
+
+    return (uint8_t) (0xFFFF - timerPeriod + (now - timerStart));
+}
+
+/**
+ * Gets the counters of the bus.
+ * @return Pointer to the statistics.
+ */
+const OneWireBusSimStatistics *OneWireBusSimGetStatistics(void)
+{
+    return &statistics;
+}
+
+/**
+ * Clears the counters of the bus.
+ */
+void OneWireBusSimResetStatistics(void)
+{
+    memset(&statistics, 0, sizeof (statistics));
+}
+
+/**
+ * Prints the counters of the bus to the standard output.
+ */
+void OneWireBusSimPrintStatistics(void)
+{
+    printf("1-wire resets: %lu, slots: %lu\n",
+           (unsigned long) statistics.resets, (unsigned long) statistics.slots);
+    printf("1-wire interrupts: %lu\n", (unsigned long) statistics.interrupts);
+    printf("1-wire time: %.1f ms (%.1f ms busy waiting, %.1f%%)\n",
+           now / 1000.0, statistics.busyMicroseconds / 1000.0,
+           now ? 100.0 * statistics.busyMicroseconds / now : 0.0);
+}
@@ -0,0 +1,86 @@
+/**
+ *  @file           OneWireBusSim.h
+ *  @author         Luis Maduro
+ *  @version        1.0
+ *  @date           03/05/2013
+ *  @copyright		GNU General Public License
+ *
+ *  @brief Linux simulator of a 1-Wire bus, a timer driven master and DS18B20
+ *  like slaves (ROM commands, search, convert T and scratchpad). The slaves
+ *  can be made overdrive capable, the overdrive slots are then timed to the
+ *  microsecond.
+ *  The time is virtual, in microseconds. The master drives the wire with
+ *  OneWireBusSimLow/Release, samples it with OneWireBusSimRead and starts a
+ *  timer whose interrupt comes on the next OneWireBusSimStep(). Polling the
+ *  timer (OneWireBusSimTimerLow) advances the time by 1 us, so the time the
+ *  master spends busy waiting is counted apart from the bus time, e.g.:
+ *  @code
+ *  gcc -DONEWIREASYNC_HOST main.c PIC18F/OneWireAsync.c Common/KernelHost/OneWireBusSim.c
+ *  @endcode
+ *  and in main():
+ *  @code
+ *  OneWireBusSimInit(OneWireAsyncInterruptHandler);
+ *  OneWireBusSimAddDevice(rom, 25 * 16);
+ *  OneWireAsyncInit();
+ *  OneWireAsyncSubmit(&transaction);
+ *  OneWireBusSimRun();
+ *  @endcode
+ */
+
+#ifndef ONEWIREBUSSIM_H
+#define	ONEWIREBUSSIM_H
+
+#ifdef	__cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**Number of slaves on the bus.*/
+#ifndef ONEWIREBUSSIM_MAX_DEVICES
+#define ONEWIREBUSSIM_MAX_DEVICES   32
+#endif
+
+/**Interrupt routine of the master driver.*/
+typedef void (*OneWireBusSimHandler)(void);
+
+typedef struct
+{
+    /**Timer interrupts*/
+    uint32_t interrupts;
+    /**Reset pulses*/
+    uint32_t resets;
+    /**Time slots (bits) after the resets*/
+    uint32_t slots;
+    /**Time the master spent polling the timer in microseconds*/
+    uint64_t busyMicroseconds;
+} OneWireBusSimStatistics;
+
+void OneWireBusSimInit(OneWireBusSimHandler handler);
+int OneWireBusSimAddDevice(const uint8_t *rom, int16_t temperature);
+void OneWireBusSimSetPresent(int index, bool present);
+void OneWireBusSimSetTemperature(int index, int16_t temperature);
+void OneWireBusSimSetAlarm(int index, bool alarm);
+void OneWireBusSimSetOverdriveCapable(int index, bool capable);
+bool OneWireBusSimStep(void);
+uint32_t OneWireBusSimRun(void);
+void OneWireBusSimWait(uint32_t microseconds);
+uint64_t OneWireBusSimGetTime(void);
+const OneWireBusSimStatistics *OneWireBusSimGetStatistics(void);
+void OneWireBusSimResetStatistics(void);
+void OneWireBusSimPrintStatistics(void);
+
+/**The hardware of the master, used through the ONEWIREASYNC_* macros.*/
+void OneWireBusSimLow(void);
+void OneWireBusSimRelease(void);
+uint8_t OneWireBusSimRead(void);
+void OneWireBusSimTimerStart(uint16_t microseconds);
+uint8_t OneWireBusSimTimerLow(void);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* ONEWIREBUSSIM_H */
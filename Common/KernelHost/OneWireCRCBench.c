@@ -0,0 +1,107 @@
+/**
+ *  @file           OneWireCRCBench.c
+ *  @author         Luis Maduro
+ *  @version        1.0
+ *  @date           03/05/2013
+ *  @copyright		GNU General Public License
+ *
+ *  @brief Linux tool that checks the known answers of Common/OneWireCRC.c and
+ *  measures its CRC8 over DS2438 pages (8 bytes and the CRC) and its CRC16
+ *  over memory pages (32 bytes and the inverted CRC). Build it once per
+ *  method, e.g.:
+ *  @code
+ *  for m in 0 1 2 3; do
+ *      gcc -O2 -DONEWIRE_CRC_METHOD=$m -o OneWireCRCBench \
+ *          Common/KernelHost/OneWireCRCBench.c Common/OneWireCRC.c
+ *      ./OneWireCRCBench
+ *  done
+ *  @endcode
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "../OneWireCRC.h"
+
+/**Pages checked per measure*/
+#define BENCH_PAGES                 64
+/**Passes over the pages*/
+#define BENCH_PASSES                20000
+
+static const char *methods[] = {"bitwise", "nibble", "table", "slice-by-4"};
+
+static double Seconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+int main(void)
+{
+    static unsigned char pages8[BENCH_PAGES][9];
+    static unsigned char pages16[BENCH_PAGES][34];
+    unsigned int crc;
+    unsigned long good = 0;
+    double start, crc8Time, crc16Time;
+    int i, j;
+
+    printf("method: %s\n", methods[ONEWIRE_CRC_METHOD]);
+
+    if (!OneWireCRCSelfTest())
+    {
+        printf("self test: FAILED\n");
+        return 1;
+    }
+
+    printf("self test: ok\n");
+
+    for (i = 0; i < BENCH_PAGES; i++)
+    {
+        for (j = 0; j < 32; j++)
+        {
+            pages16[i][j] = (unsigned char) (i * 31 + j * 7);
+        }
+
+        for (j = 0; j < 8; j++)
+        {
+            pages8[i][j] = pages16[i][j];
+        }
+
+        pages8[i][8] = OneWireCRC8(pages8[i], 8);
+        crc = ~OneWireCRC16(pages16[i], 32, 0);
+        pages16[i][32] = (unsigned char) crc;
+        pages16[i][33] = (unsigned char) (crc >> 8);
+    }
+
+    start = Seconds();
+    for (i = 0; i < BENCH_PASSES; i++)
+    {
+        good += OneWireCheckCRC8Blocks(&pages8[0][0], 9, BENCH_PAGES);
+    }
+    crc8Time = Seconds() - start;
+
+    start = Seconds();
+    for (i = 0; i < BENCH_PASSES; i++)
+    {
+        good += OneWireCheckCRC16Blocks(&pages16[0][0], 34, BENCH_PAGES);
+    }
+    crc16Time = Seconds() - start;
+
+    if (good != 2UL * BENCH_PASSES)
+    {
+        printf("check: FAILED\n");
+        return 1;
+    }
+
+    printf("CRC8 : %6.2f ns/byte, %7.1f ns per DS2438 page\n",
+           crc8Time * 1e9 / ((double) BENCH_PASSES * BENCH_PAGES * 9),
+           crc8Time * 1e9 / ((double) BENCH_PASSES * BENCH_PAGES));
+    printf("CRC16: %6.2f ns/byte, %7.1f ns per 32 byte page\n",
+           crc16Time * 1e9 / ((double) BENCH_PASSES * BENCH_PAGES * 34),
+           crc16Time * 1e9 / ((double) BENCH_PASSES * BENCH_PAGES));
+
+    return 0;
+}
@@ -0,0 +1,608 @@
+/**
+ *  @file           uKernelPreempt.c
+ *  @author         Luis Maduro
+ *  @version        1.0
+ *  @date           03/05/2013
+ *  @copyright		GNU General Public License
+ *
+ *  @brief Preemptive backend of uKernel for Linux, ucontext and SIGALRM.
+ *  Everything that touches the task table runs with SIGALRM blocked, the same
+ *  way the Cortex-M3 port will run it with the interrupts disabled.
+ */
+
+#define _XOPEN_SOURCE 700
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <ucontext.h>
+#include <sys/time.h>
+#include "uKernelPreempt.h"
+
+/**The task is waiting for its release or running*/
+#define PREEMPT_READY               0
+/**The task waits on a mutex or a semaphore*/
+#define PREEMPT_BLOCKED             1
+/**ONETIME task that already ran, or paused task*/
+#define PREEMPT_DONE                2
+
+/**Index of the idle context (main)*/
+#define PREEMPT_IDLE                (-1)
+
+typedef struct
+{
+    /**Descriptor of the task on uKernel*/
+    uKernelTaskDescriptor *pDescriptor;
+    /**Saved context of the task*/
+    ucontext_t context;
+    /**Stack of the task*/
+    uint8_t *stack;
+    /**PREEMPT_READY, PREEMPT_BLOCKED or PREEMPT_DONE*/
+    uint8_t state;
+    /**Object the task is blocked on*/
+    void *blockedOn;
+    /**Tick when the task can run again (release or end of a delay)*/
+    uint32_t wakeup;
+    /**Priority of the task, the lowest runs first*/
+    uint32_t basePriority;
+    /**Priority raised by the inheritance, if any*/
+    uint32_t priority;
+    /**Number of runs of the task body*/
+    uint32_t runs;
+    /**When the task blocked the last time*/
+    struct timespec blockedSince;
+    /**Longest time blocked on a mutex or semaphore, in microseconds*/
+    uint32_t maxBlockedMicroseconds;
+} uKernelPreemptTask;
+
+static uKernelPreemptTask tasks[UKERNEL_PREEMPT_MAX_TASKS];
+static uint8_t numberTasks;
+/**Index of the task running, PREEMPT_IDLE for main*/
+static volatile int8_t current = PREEMPT_IDLE;
+static ucontext_t idleContext;
+static sigset_t alarmMask;
+static struct timespec switchStart;
+static uKernelPreemptStatistics statistics;
+
+static void PreemptReschedule(bool tick);
+
+/**
+ * Nanoseconds between two times.
+ */
+static uint64_t PreemptElapsed(const struct timespec *pStart,
+                               const struct timespec *pEnd)
+{
+    return (uint64_t) (pEnd->tv_sec - pStart->tv_sec) * 1000000000ULL
+            + pEnd->tv_nsec - pStart->tv_nsec;
+}
+
+/**
+ * Called on the context that was just switched in, accounts the switch.
+ */
+static void PreemptSwitchDone(void)
+{
+    struct timespec now;
+    uint64_t elapsed;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    elapsed = PreemptElapsed(&switchStart, &now);
+
+    statistics.switches++;
+    statistics.switchNanoseconds += elapsed;
+    if (elapsed > statistics.maxSwitchNanoseconds)
+    {
+        statistics.maxSwitchNanoseconds = (uint32_t) elapsed;
+    }
+}
+
+static void PreemptBlock(void)
+{
+    sigprocmask(SIG_BLOCK, &alarmMask, NULL);
+}
+
+static void PreemptUnblock(void)
+{
+    sigprocmask(SIG_UNBLOCK, &alarmMask, NULL);
+}
+
+/**
+ * Priority of a task from its descriptor.
+ */
+static uint32_t PreemptPriority(uKernelTaskDescriptor *pTask)
+{
+#if UKERNEL_SCHEDULING_POLICY == UKERNEL_POLICY_FIXED_PRIORITY
+    return pTask->priority;
+#else
+    //rate monotonic, the shortest period first
+    return pTask->userTasksInterval;
+#endif
+}
+
+/**
+ * Body of every task: runs the task body on each release.
+ */
+static void PreemptTaskEntry(int index)
+{
+    uKernelPreemptTask *pTask = &tasks[index];
+    uKernelTaskDescriptor *pDescriptor = pTask->pDescriptor;
+
+    PreemptSwitchDone();
+    PreemptUnblock();
+
+    while (1)
+    {
+        pDescriptor->taskPointer();
+
+        PreemptBlock();
+        pTask->runs++;
+
+        if (pDescriptor->taskStatus & UKERNEL_ONETIME)
+        {
+            pDescriptor->taskStatus = UKERNEL_PAUSED;
+        }
+
+        if (pDescriptor->taskStatus == UKERNEL_PAUSED)
+        {
+            pTask->state = PREEMPT_DONE;
+        }
+        else
+        {
+            //next release on the grid of the period
+            pTask->wakeup += pDescriptor->userTasksInterval;
+
+            //this trick overrun the overflow of _counterMs
+            if ((int32_t) (_counterMs - pTask->wakeup) >=
+                    (int32_t) pDescriptor->userTasksInterval)
+            {
+                pTask->wakeup = _counterMs;
+            }
+        }
+
+        PreemptReschedule(false);
+        PreemptUnblock();
+    }
+}
+
+/**
+ * Index of the task of a descriptor.
+ */
+static int8_t PreemptFind(uKernelTaskDescriptor *pDescriptor)
+{
+    uint8_t index;
+
+    for (index = 0; index < numberTasks; index++)
+    {
+        if (tasks[index].pDescriptor == pDescriptor)
+        {
+            return (int8_t) index;
+        }
+    }
+
+    return PREEMPT_IDLE;
+}
+
+/**
+ * Switches to the ready task with the highest priority, or to idle. Called
+ * with SIGALRM blocked or from its handler.
+ * @param tick True if called from the tick.
+ */
+static void PreemptReschedule(bool tick)
+{
+    int8_t best = PREEMPT_IDLE;
+    int8_t previous = current;
+    uint8_t index;
+    ucontext_t *pFrom;
+
+    for (index = 0; index < numberTasks; index++)
+    {
+        if ((tasks[index].state == PREEMPT_READY)
+                && (int32_t) (_counterMs - tasks[index].wakeup) >= 0
+                && ((best == PREEMPT_IDLE)
+                    || (tasks[index].priority < tasks[best].priority)))
+        {
+            best = (int8_t) index;
+        }
+    }
+
+    if (best == previous)
+    {
+        return;
+    }
+
+    if (tick && (previous != PREEMPT_IDLE)
+            && (tasks[previous].state == PREEMPT_READY))
+    {
+        statistics.preemptions++;
+    }
+
+    pFrom = (previous == PREEMPT_IDLE) ? &idleContext
+            : &tasks[previous].context;
+    current = best;
+
+    clock_gettime(CLOCK_MONOTONIC, &switchStart);
+    swapcontext(pFrom, (best == PREEMPT_IDLE) ? &idleContext
+                : &tasks[best].context);
+    PreemptSwitchDone();
+}
+
+/**
+ * The 1 ms tick, SysTick of the reference port.
+ */
+static void PreemptTick(int signal)
+{
+    (void) signal;
+
+    uKernelTimerInterruptHandler();
+    PreemptReschedule(true);
+}
+
+/**
+ * Creates the contexts of the tasks added to uKernel.
+ * @return False if there are too many tasks or no memory for the stacks.
+ */
+static bool PreemptCreateTasks(void)
+{
+    uKernelTaskDescriptor *pDescriptor = NULL;
+    uKernelPreemptTask *pTask;
+
+    while ((pDescriptor = uKernelGetNextTask(pDescriptor)) != NULL)
+    {
+        if (PreemptFind(pDescriptor) != PREEMPT_IDLE)
+        {
+            continue;
+        }
+
+        if (numberTasks == UKERNEL_PREEMPT_MAX_TASKS)
+        {
+            return false;
+        }
+
+        pTask = &tasks[numberTasks];
+        memset(pTask, 0, sizeof (*pTask));
+        pTask->pDescriptor = pDescriptor;
+        pTask->stack = malloc(UKERNEL_PREEMPT_STACK_SIZE);
+        if (pTask->stack == NULL)
+        {
+            return false;
+        }
+        memset(pTask->stack, UKERNEL_PREEMPT_STACK_FILL,
+               UKERNEL_PREEMPT_STACK_SIZE);
+
+        pTask->state = (pDescriptor->taskStatus == UKERNEL_PAUSED)
+                ? PREEMPT_DONE : PREEMPT_READY;
+        pTask->wakeup = pDescriptor->plannedTask;
+        pTask->basePriority = PreemptPriority(pDescriptor);
+        pTask->priority = pTask->basePriority;
+
+        getcontext(&pTask->context);
+        pTask->context.uc_stack.ss_sp = pTask->stack;
+        pTask->context.uc_stack.ss_size = UKERNEL_PREEMPT_STACK_SIZE;
+        pTask->context.uc_link = &idleContext;
+        sigemptyset(&pTask->context.uc_sigmask);
+        makecontext(&pTask->context, (void (*)(void)) PreemptTaskEntry, 1,
+                    (int) numberTasks);
+
+        numberTasks++;
+    }
+
+    return true;
+}
+
+/**
+ * Runs the tasks of uKernel preemptively, in real time, for some time. Tasks
+ * added meanwhile start on the next call.
+ * @param milliseconds Time to run.
+ * @return False if the tasks could not be created.
+ */
+bool uKernelPreemptRun(uint32_t milliseconds)
+{
+    struct sigaction action;
+    struct itimerval timer;
+    sigset_t waitMask;
+    uint32_t end;
+
+    sigemptyset(&alarmMask);
+    sigaddset(&alarmMask, SIGALRM);
+    PreemptBlock();
+
+    if (!PreemptCreateTasks())
+    {
+        PreemptUnblock();
+        return false;
+    }
+
+    memset(&action, 0, sizeof (action));
+    action.sa_handler = PreemptTick;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGALRM, &action, NULL);
+
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = 1000;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_REAL, &timer, NULL);
+
+    end = _counterMs + milliseconds;
+    sigprocmask(SIG_BLOCK, NULL, &waitMask);
+    sigdelset(&waitMask, SIGALRM);
+
+    current = PREEMPT_IDLE;
+    PreemptReschedule(false);
+
+    //idle, the tick switches to the tasks
+    while ((int32_t) (end - _counterMs) > 0)
+    {
+        sigsuspend(&waitMask);
+    }
+
+    memset(&timer, 0, sizeof (timer));
+    setitimer(ITIMER_REAL, &timer, NULL);
+    PreemptUnblock();
+
+    return true;
+}
+
+/**
+ * Blocks the running task for some time, the other tasks run meanwhile.
+ * @param milliseconds Time to wait.
+ */
+void uKernelPreemptDelay(uint32_t milliseconds)
+{
+    PreemptBlock();
+    if (current != PREEMPT_IDLE)
+    {
+        tasks[current].wakeup = _counterMs + milliseconds;
+        PreemptReschedule(false);
+    }
+    PreemptUnblock();
+}
+
+/**
+ * Blocks the running task on an object and lets the others run.
+ */
+static void PreemptWait(void *pObject)
+{
+    uKernelPreemptTask *pTask = &tasks[current];
+
+    pTask->state = PREEMPT_BLOCKED;
+    pTask->blockedOn = pObject;
+    PreemptReschedule(false);
+}
+
+/**
+ * Wakes all the tasks blocked on an object, the one with the highest priority
+ * will take it.
+ */
+static void PreemptWakeAll(void *pObject)
+{
+    uint8_t index;
+
+    for (index = 0; index < numberTasks; index++)
+    {
+        if ((tasks[index].state == PREEMPT_BLOCKED)
+                && (tasks[index].blockedOn == pObject))
+        {
+            tasks[index].state = PREEMPT_READY;
+            tasks[index].blockedOn = NULL;
+        }
+    }
+}
+
+/**
+ * Keeps the longest time the running task was blocked.
+ */
+static void PreemptBlockedTime(uKernelPreemptTask *pTask)
+{
+    struct timespec now;
+    uint32_t blocked;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    blocked = (uint32_t) (PreemptElapsed(&pTask->blockedSince, &now) / 1000);
+
+    if (blocked > pTask->maxBlockedMicroseconds)
+    {
+        pTask->maxBlockedMicroseconds = blocked;
+    }
+}
+
+/**
+ * Initiates a mutex, free.
+ * @param pMutex Mutex.
+ */
+void uKernelMutexInit(uKernelMutex *pMutex)
+{
+    pMutex->owner = PREEMPT_IDLE;
+}
+
+/**
+ * Takes a mutex, waiting if another task holds it. With
+ * UKERNEL_PREEMPT_INHERITANCE the task that holds it runs with the priority of
+ * the waiting task until it gives it back.
+ * @param pMutex Mutex.
+ */
+void uKernelMutexLock(uKernelMutex *pMutex)
+{
+    uKernelPreemptTask *pTask;
+
+    PreemptBlock();
+
+    if (current == PREEMPT_IDLE)
+    {
+        PreemptUnblock();
+        return;
+    }
+
+    pTask = &tasks[current];
+    clock_gettime(CLOCK_MONOTONIC, &pTask->blockedSince);
+
+    while (pMutex->owner != PREEMPT_IDLE)
+    {
+#if UKERNEL_PREEMPT_INHERITANCE
+        if (tasks[pMutex->owner].priority > pTask->priority)
+        {
+            tasks[pMutex->owner].priority = pTask->priority;
+        }
+#endif
+        PreemptWait(pMutex);
+    }
+
+    pMutex->owner = current;
+    PreemptBlockedTime(pTask);
+
+    PreemptUnblock();
+}
+
+/**
+ * Gives back a mutex taken by the running task.
+ * @param pMutex Mutex.
+ */
+void uKernelMutexUnlock(uKernelMutex *pMutex)
+{
+    PreemptBlock();
+
+    if ((current != PREEMPT_IDLE) && (pMutex->owner == current))
+    {
+        pMutex->owner = PREEMPT_IDLE;
+        //one mutex at a time is inherited, back to the own priority
+        tasks[current].priority = tasks[current].basePriority;
+        PreemptWakeAll(pMutex);
+        PreemptReschedule(false);
+    }
+
+    PreemptUnblock();
+}
+
+/**
+ * Initiates a semaphore.
+ * @param pSemaphore Semaphore.
+ * @param count Initial count.
+ */
+void uKernelSemaphoreInit(uKernelSemaphore *pSemaphore, uint16_t count)
+{
+    pSemaphore->count = count;
+}
+
+/**
+ * Takes a semaphore, waiting while its count is 0.
+ * @param pSemaphore Semaphore.
+ */
+void uKernelSemaphoreWait(uKernelSemaphore *pSemaphore)
+{
+    uKernelPreemptTask *pTask;
+
+    PreemptBlock();
+
+    if (current != PREEMPT_IDLE)
+    {
+        pTask = &tasks[current];
+        clock_gettime(CLOCK_MONOTONIC, &pTask->blockedSince);
+
+        while (pSemaphore->count == 0)
+        {
+            PreemptWait(pSemaphore);
+        }
+
+        PreemptBlockedTime(pTask);
+    }
+
+    if (pSemaphore->count != 0)
+    {
+        pSemaphore->count--;
+    }
+
+    PreemptUnblock();
+}
+
+/**
+ * Gives a semaphore, a waiting task with a higher priority runs at once. It
+ * can be called from the tick (the interrupts of the reference port).
+ * @param pSemaphore Semaphore.
+ */
+void uKernelSemaphorePost(uKernelSemaphore *pSemaphore)
+{
+    PreemptBlock();
+
+    pSemaphore->count++;
+    PreemptWakeAll(pSemaphore);
+    PreemptReschedule(false);
+
+    PreemptUnblock();
+}
+
+/**
+ * Stack used by a task so far, the high water mark.
+ * @param pTaskDescriptor Descriptor of the task.
+ * @return Bytes of the stack that were written, 0 if the task is unknown.
+ */
+uint32_t uKernelPreemptGetStackUsed(uKernelTaskDescriptor *pTaskDescriptor)
+{
+    int8_t index = PreemptFind(pTaskDescriptor);
+    uint32_t untouched = 0;
+
+    if (index == PREEMPT_IDLE)
+    {
+        return 0;
+    }
+
+    //the stack grows down, the untouched bytes are at the bottom
+    while ((untouched < UKERNEL_PREEMPT_STACK_SIZE)
+            && (tasks[index].stack[untouched] == UKERNEL_PREEMPT_STACK_FILL))
+    {
+        untouched++;
+    }
+
+    return UKERNEL_PREEMPT_STACK_SIZE - untouched;
+}
+
+/**
+ * Longest time a task waited on a mutex or a semaphore, shows the priority
+ * inversion.
+ * @param pTaskDescriptor Descriptor of the task.
+ * @return Time in microseconds.
+ */
+uint32_t uKernelPreemptGetMaxBlocked(uKernelTaskDescriptor *pTaskDescriptor)
+{
+    int8_t index = PreemptFind(pTaskDescriptor);
+
+    return (index == PREEMPT_IDLE) ? 0 : tasks[index].maxBlockedMicroseconds;
+}
+
+/**
+ * Gets the counters of the context switches.
+ * @return Pointer to the statistics.
+ */
+const uKernelPreemptStatistics *uKernelPreemptGetStatistics(void)
+{
+    return &statistics;
+}
+
+/**
+ * Prints the tasks and the cost of the context switches.
+ */
+void uKernelPreemptPrintStatistics(void)
+{
+    uint8_t index;
+
+    for (index = 0; index < numberTasks; index++)
+    {
+        printf("task %u: priority %lu, runs %lu, stack %lu bytes, "
+               "max blocked %lu us\n", index,
+               (unsigned long) tasks[index].basePriority,
+               (unsigned long) tasks[index].runs,
+               (unsigned long) uKernelPreemptGetStackUsed(
+                    tasks[index].pDescriptor),
+               (unsigned long) tasks[index].maxBlockedMicroseconds);
+    }
+
+    printf("context switches: %lu (%lu preemptions)\n",
+           (unsigned long) statistics.switches,
+           (unsigned long) statistics.preemptions);
+
+    if (statistics.switches != 0)
+    {
+        printf("switch cost: %.0f ns average, %lu ns max\n",
+               (double) statistics.switchNanoseconds / statistics.switches,
+               (unsigned long) statistics.maxSwitchNanoseconds);
+    }
+}
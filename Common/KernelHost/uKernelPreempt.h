@@ -0,0 +1,105 @@
+/**
+ *  @file           uKernelPreempt.h
+ *  @author         Luis Maduro
+ *  @version        1.0
+ *  @date           03/05/2013
+ *  @copyright		GNU General Public License
+ *
+ *  @brief Preemptive backend of uKernel for Linux, the reference for a future
+ *  Cortex-M3 port.
+ *  Each task gets its own stack (ucontext) and a 1 ms SIGALRM plays the
+ *  SysTick: on every tick the ready task with the highest priority runs,
+ *  preempting the one that was running. The tasks are added as always with
+ *  uKernelAddTask(), the priority is the period (rate monotonic) or, built
+ *  with UKERNEL_POLICY_FIXED_PRIORITY, the one set by uKernelSetTaskPriority().
+ *  It also has mutexes (with priority inheritance), semaphores, stack high
+ *  water marks and measures the cost of the context switches, e.g.:
+ *  @code
+ *  gcc -ICommon/uKernel main.c Common/uKernel/uKernel.c
+ *      Common/KernelHost/uKernelPreempt.c
+ *  @endcode
+ *  and in main():
+ *  @code
+ *  uKernelInit();
+ *  uKernelAddTask(&sampleDescriptor, Sample, 5, UKERNEL_SCHEDULED);
+ *  uKernelAddTask(&logDescriptor, Log, 100, UKERNEL_SCHEDULED);
+ *  uKernelPreemptRun(2000);
+ *  uKernelPreemptPrintStatistics();
+ *  @endcode
+ *  Events, messages, coroutines and uKernelSleep are for the cooperative
+ *  scheduler, a preempted task waits with uKernelPreemptDelay() or on a
+ *  semaphore.
+ */
+
+#ifndef UKERNELPREEMPT_H
+#define	UKERNELPREEMPT_H
+
+#ifdef	__cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../uKernel/uKernel.h"
+
+/**Maximum number of tasks run by the preemptive backend.*/
+#ifndef UKERNEL_PREEMPT_MAX_TASKS
+#define UKERNEL_PREEMPT_MAX_TASKS   8
+#endif
+
+/**Stack of each task in bytes, printf alone takes a few kB on Linux.*/
+#ifndef UKERNEL_PREEMPT_STACK_SIZE
+#define UKERNEL_PREEMPT_STACK_SIZE  65536
+#endif
+
+/**Value written on the stacks to find how much of them was used.*/
+#define UKERNEL_PREEMPT_STACK_FILL  0xA5
+
+/**Set to 0 to see the priority inversion without priority inheritance.*/
+#ifndef UKERNEL_PREEMPT_INHERITANCE
+#define UKERNEL_PREEMPT_INHERITANCE 1
+#endif
+
+typedef struct
+{
+    /**Index of the task that holds the mutex, -1 if it is free*/
+    volatile int8_t owner;
+} uKernelMutex;
+
+typedef struct
+{
+    /**Number of times the semaphore can be taken without waiting*/
+    volatile uint16_t count;
+} uKernelSemaphore;
+
+typedef struct
+{
+    /**Context switches*/
+    uint32_t switches;
+    /**Total time of the context switches in nanoseconds*/
+    uint64_t switchNanoseconds;
+    /**Longest context switch in nanoseconds*/
+    uint32_t maxSwitchNanoseconds;
+    /**Ticks where a task was preempted by another one*/
+    uint32_t preemptions;
+} uKernelPreemptStatistics;
+
+bool uKernelPreemptRun(uint32_t milliseconds);
+void uKernelPreemptDelay(uint32_t milliseconds);
+void uKernelMutexInit(uKernelMutex *pMutex);
+void uKernelMutexLock(uKernelMutex *pMutex);
+void uKernelMutexUnlock(uKernelMutex *pMutex);
+void uKernelSemaphoreInit(uKernelSemaphore *pSemaphore, uint16_t count);
+void uKernelSemaphoreWait(uKernelSemaphore *pSemaphore);
+void uKernelSemaphorePost(uKernelSemaphore *pSemaphore);
+uint32_t uKernelPreemptGetStackUsed(uKernelTaskDescriptor *pTaskDescriptor);
+uint32_t uKernelPreemptGetMaxBlocked(uKernelTaskDescriptor *pTaskDescriptor);
+const uKernelPreemptStatistics *uKernelPreemptGetStatistics(void);
+void uKernelPreemptPrintStatistics(void);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* UKERNELPREEMPT_H */
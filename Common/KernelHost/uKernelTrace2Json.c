@@ -0,0 +1,206 @@
+/**
+ *  @file           uKernelTrace2Json.c
+ *  @author         Luis Maduro
+ *  @version        1.0
+ *  @date           03/05/2013
+ *  @copyright		GNU General Public License
+ *
+ *  @brief Linux tool that converts a trace ring dumped by uKernelTraceDump()
+ *  into the Chrome trace format (JSON), to be opened in chrome://tracing or
+ *  https://ui.perfetto.dev.
+ *  The dump can come straight from the USART or the VCP, anything before the
+ *  header is skipped, e.g.:
+ *  @code
+ *  gcc -o uKernelTrace2Json Common/KernelHost/uKernelTrace2Json.c
+ *  cat /dev/ttyUSB0 > dump.bin
+ *  ./uKernelTrace2Json dump.bin > trace.json
+ *  @endcode
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**Size of the header of the dump*/
+#define TRACE_HEADER_SIZE           10
+/**Size of each record of the dump*/
+#define TRACE_RECORD_SIZE           8
+/**Tasks that can be open at the same time, uKernelSleep nests them*/
+#define TRACE_NESTING               16
+
+/**Same values as uKernelTraceType*/
+#define TRACE_TASK_START            0x01
+#define TRACE_TASK_END              0x02
+#define TRACE_POST                  0x03
+#define TRACE_IDLE_ENTER            0x04
+#define TRACE_IDLE_EXIT             0x05
+
+static bool firstEvent = true;
+
+/**
+ * Finds the header of the dump.
+ * @param file Dump.
+ * @return True if the header was found, the file is left after the magic.
+ */
+static bool FindHeader(FILE *file)
+{
+    const char magic[4] = {'u', 'K', 'T', 1};
+    int matched = 0;
+    int c;
+
+    while ((c = fgetc(file)) != EOF)
+    {
+        if (c == (unsigned char) magic[matched])
+        {
+            matched++;
+            if (matched == 4)
+            {
+                return true;
+            }
+        }
+        else
+        {
+            matched = (c == 'u') ? 1 : 0;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Prints one event of the Chrome trace.
+ * @param name Name of the event.
+ * @param phase B (begin), E (end) or i (instant).
+ * @param timestamp Time in microseconds.
+ */
+static void PrintEvent(const char *name, char phase, double timestamp)
+{
+    printf("%s\n    {\"name\": \"%s\", \"ph\": \"%c\", \"ts\": %.3f, "
+           "\"pid\": 1, \"tid\": 1%s}",
+           firstEvent ? "" : ",", name, phase, timestamp,
+           phase == 'i' ? ", \"s\": \"t\"" : "");
+    firstEvent = false;
+}
+
+int main(int argc, char *argv[])
+{
+    FILE *file = stdin;
+    uint8_t header[TRACE_HEADER_SIZE - 4];
+    uint8_t record[TRACE_RECORD_SIZE];
+    uint16_t count;
+    uint16_t i;
+    uint32_t cyclesPerMs;
+    uint32_t firstTick = 0;
+    uint32_t tick;
+    uint16_t cycles;
+    uint8_t openTasks[TRACE_NESTING];
+    uint8_t openDepth = 0;
+    bool idleOpen = false;
+    double timestamp;
+    char name[32];
+
+    if (argc > 1)
+    {
+        file = fopen(argv[1], "rb");
+        if (file == NULL)
+        {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    if (!FindHeader(file)
+            || fread(header, 1, sizeof (header), file) != sizeof (header))
+    {
+        fprintf(stderr, "no uKernel trace found\n");
+        return 1;
+    }
+
+    count = header[0] | (header[1] << 8);
+    cyclesPerMs = header[2] | (header[3] << 8) | ((uint32_t) header[4] << 16)
+            | ((uint32_t) header[5] << 24);
+
+    printf("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+
+    for (i = 0; i < count; i++)
+    {
+        if (fread(record, 1, sizeof (record), file) != sizeof (record))
+        {
+            fprintf(stderr, "dump cut after %u of %u records\n", i, count);
+            break;
+        }
+
+        cycles = record[2] | (record[3] << 8);
+        tick = record[4] | (record[5] << 8) | ((uint32_t) record[6] << 16)
+                | ((uint32_t) record[7] << 24);
+
+        if (i == 0)
+        {
+            firstTick = tick;
+        }
+
+        //the subtraction also works if _counterMs overflowed
+        timestamp = (double) (uint32_t) (tick - firstTick) * 1000.0;
+        if (cyclesPerMs != 0)
+        {
+            timestamp += (double) cycles * 1000.0 / cyclesPerMs;
+        }
+
+        switch (record[0])
+        {
+            case TRACE_TASK_START:
+                if (openDepth < TRACE_NESTING)
+                {
+                    snprintf(name, sizeof (name), "task %u", record[1]);
+                    PrintEvent(name, 'B', timestamp);
+                    openTasks[openDepth++] = record[1];
+                }
+                break;
+
+            case TRACE_TASK_END:
+                //the start may have been overwritten on the ring, a task that
+                //slept ends after the ones that ran inside its sleep
+                if (openDepth > 0 && openTasks[openDepth - 1] == record[1])
+                {
+                    snprintf(name, sizeof (name), "task %u", record[1]);
+                    PrintEvent(name, 'E', timestamp);
+                    openDepth--;
+                }
+                break;
+
+            case TRACE_POST:
+                snprintf(name, sizeof (name), "post task %u", record[1]);
+                PrintEvent(name, 'i', timestamp);
+                break;
+
+            case TRACE_IDLE_ENTER:
+                PrintEvent("idle", 'B', timestamp);
+                idleOpen = true;
+                break;
+
+            case TRACE_IDLE_EXIT:
+                if (idleOpen)
+                {
+                    PrintEvent("idle", 'E', timestamp);
+                    idleOpen = false;
+                }
+                break;
+
+            default:
+                //records of the application
+                snprintf(name, sizeof (name), "mark %u:%u", record[0],
+                         record[1]);
+                PrintEvent(name, 'i', timestamp);
+                break;
+        }
+    }
+
+    printf("\n]}\n");
+
+    if (file != stdin)
+    {
+        fclose(file);
+    }
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+/**
+ *  @file       OneWireCRC.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       June 2013
+ *  @brief      CRC8 and CRC16 of the 1-Wire devices.
+ *
+ *  Copyright (C) 2013  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  One implementation for the OneWire (bit banged) and DS2482 drivers. The
+ *  method is chosen at compile time with ONEWIRE_CRC_METHOD, the results are
+ *  the same:
+ *  - ONEWIRE_CRC_BITWISE: no table, 8 shifts per byte.
+ *  - ONEWIRE_CRC_NIBBLE: two 16 entry tables per CRC (32 bytes for the CRC8,
+ *    64 for the CRC16), one lookup per nibble. The default, for the PIC.
+ *  - ONEWIRE_CRC_TABLE: one 256 entry table per CRC (256 and 512 bytes).
+ *  - ONEWIRE_CRC_SLICE4: four 256 entry tables per CRC (1 and 2 KB), four
+ *    bytes per step, for the Cortex-M3.
+ *  OneWireCRCSelfTest checks the known answers and Common/KernelHost/
+ *  OneWireCRCBench.c measures each method on Linux.
+ */
+
+#ifndef _ONEWIRECRC_H_
+#define _ONEWIRECRC_H_
+
+#include <stdbool.h>
+
+#define ONEWIRE_CRC_BITWISE     0
+#define ONEWIRE_CRC_NIBBLE      1
+#define ONEWIRE_CRC_TABLE       2
+#define ONEWIRE_CRC_SLICE4      3
+
+// ONEWIRE_CRC8_TABLE set to 1, from the old OneWire configuration, selects
+// the byte table.
+#ifndef ONEWIRE_CRC_METHOD
+#if defined(ONEWIRE_CRC8_TABLE) && ONEWIRE_CRC8_TABLE
+#define ONEWIRE_CRC_METHOD      ONEWIRE_CRC_TABLE
+#else
+#define ONEWIRE_CRC_METHOD      ONEWIRE_CRC_NIBBLE
+#endif
+#endif
+
+/**Remainder of the CRC16 over the data and its inverted CRC.*/
+#define ONEWIRE_CRC16_RESIDUE   0xB001
+
+// Compute a Dallas Semiconductor 8 bit CRC, these are used in the
+// ROM and scratchpad registers.
+unsigned char OneWireCRC8(const unsigned char *addr, unsigned char len);
+
+// Compute a Dallas Semiconductor 16 bit CRC.  This is required to check
+// the integrity of data received from many 1-Wire devices.  Note that the
+// CRC computed here is *not* what you'll get from the 1-Wire network,
+// for two reasons:
+//   1) The CRC is transmitted bitwise inverted.
+//   2) Depending on the endian-ness of your processor, the binary
+//      representation of the two-byte return value may have a different
+//      byte order than the two bytes you get from 1-Wire.
+// @param input - Array of bytes to checksum.
+// @param len - How many bytes to use.
+// @param crc - The crc starting value (optional)
+// @return The CRC16, as defined by Dallas Semiconductor.
+unsigned int OneWireCRC16(const unsigned char* input, unsigned int len, unsigned int crc);
+
+// Compute the 1-Wire CRC16 and compare it against the received CRC.
+// Example usage (reading a DS2408):
+//    // Put everything in a buffer so we can compute the CRC easily.
+//    unsigned char buf[13];
+//    buf[0] = 0xF0;    // Read PIO Registers
+//    buf[1] = 0x88;    // LSB address
+//    buf[2] = 0x00;    // MSB address
+//    WriteBytes(net, buf, 3);    // Write 3 cmd bytes
+//    ReadBytes(net, buf+3, 10);  // Read 6 data bytes, 2 0xFF, 2 CRC16
+//    if (!CheckCRC16(buf, 11, &buf[11])) {
+//        // Handle error.
+//    }
+//
+// @param input - Array of bytes to checksum.
+// @param len - How many bytes to use.
+// @param inverted_crc - The two CRC16 bytes in the received data.
+//                       This should just point into the received data,
+//                       *not* at a 16-bit integer.
+// @param crc - The crc starting value (optional)
+// @return True, iff the CRC matches.
+bool OneWireCheckCRC16(const unsigned char* input, unsigned int len, const unsigned char* inverted_crc, unsigned int crc);
+
+bool OneWireCheckCRC8Blocks(const unsigned char *data, unsigned char blockLength,
+                            unsigned char blocks);
+bool OneWireCheckCRC16Blocks(const unsigned char *data, unsigned int blockLength,
+                             unsigned char blocks);
+bool OneWireCRCSelfTest(void);
+
+#endif /* _ONEWIRECRC_H_ */
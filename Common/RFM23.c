@@ -49,6 +49,13 @@ void RFM2xBurstWriteByte(unsigned char reg, unsigned char *src, unsigned char le
 
 void RFM2xInterruptHandler(void)
 {
+    RFM2xServiceInterrupt(NULL);
+}
+
+void RFM2xServiceInterrupt(void *argument)
+{
+    (void) argument;
+
     RFM2xITStatus1.IRQReg = RFM2xReadByte(RFM2X_REG_03_INTERRUPT_STATUS1);
     RFM2xITStatus2.IRQReg = RFM2xReadByte(RFM2X_REG_04_INTERRUPT_STATUS2);
 
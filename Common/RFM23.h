@@ -452,6 +452,11 @@ void RFM2xWriteByte(unsigned char reg, unsigned char val);
 void RFM2xBurstReadByte(unsigned char reg, unsigned char *dest, unsigned char len);
 void RFM2xBurstWriteByte(unsigned char reg, unsigned char *src, unsigned char len);
 void RFM2xInterruptHandler(void);
+// Does the SPI work of RFM2xInterruptHandler. With uKernel (built with
+// UKERNEL_USE_DEFERRED_WORK set to 1) the ISR only clears its flag and calls
+// uKernelDefer(RFM2xServiceInterrupt, NULL), the nIRQ pin
+// stays low until the status registers are read here.
+void RFM2xServiceInterrupt(void *argument);
 unsigned char RFM2xInit(void);
 unsigned char RFM2xStatusRead(void);
 void RFM2xSetMode(unsigned char mode);
@@ -1,41 +1,59 @@
 /* This file is part of Tasker library.
    Please check the README file and the notes
    inside the Tasker.h file
+   The tasks are run by uKernel, this file only keeps the slots and handles
+   of the Tasker API.
  */
 
 //include required libraries
 #include "Tasker.h"
 
-volatile unsigned long _counterMs = 0;
 volatile unsigned char _initialized = 0;
-volatile unsigned char numberTasks;
+/**First free slot of the list of free slots*/
+unsigned char freeSlot;
 
 TaskerCore Tasks[MAXIMUM_TASKS];
 
-void TaskerSetTimer();
-unsigned char TaskerSetTask(void (*)(void),
-                            unsigned char,
-                            unsigned long taskInterval);
+TaskerCore *TaskerGetTask(tTaskerHandle handle);
 
 void TaskerBegin(void)
 {
+    unsigned char tempI;
+
+    //the core is only initiated once, the time and its other tasks are kept
+    uKernelInit();
+
+    //all the slots are free and linked in order
+    for (tempI = 0; tempI < MAXIMUM_TASKS; tempI++)
+    {
+        //TaskerBegin called again, our old tasks leave the core list
+        if (_initialized && (Tasks[tempI].descriptor.taskPointer != NULL))
+        {
+            uKernelRemoveTask(&Tasks[tempI].descriptor);
+        }
+        Tasks[tempI].descriptor.taskPointer = NULL;
+        Tasks[tempI].descriptor.pTaskNext = NULL;
+        Tasks[tempI].descriptor.pTaskPrevious = NULL;
+        Tasks[tempI].descriptor.onList = false;
+        Tasks[tempI].generation = 1;
+        Tasks[tempI].nextFree = tempI + 1;
+    }
+    Tasks[MAXIMUM_TASKS - 1].nextFree = TASKER_NO_SLOT;
+    freeSlot = 0;
     _initialized = true;
-    numberTasks = 0;
 }
 
-unsigned char TaskerAddTask(void (*userTask)(void),
-                            unsigned long taskInterval,
+tTaskerHandle TaskerAddTask(void (*userTask)(void),
+                            uint32_t taskInterval,
                             tTaskStatus taskStatus)
 {
-    if ((_initialized == false) || (numberTasks == MAXIMUM_TASKS))
-    {
-        //max number of allowed tasks reached
-        return false;
-    }
+    unsigned char tempI;
 
-    if ((taskInterval < 1) || (taskInterval > MAX_TASK_INTERVAL))
+    if ((_initialized == false) || (freeSlot == TASKER_NO_SLOT)
+            || (userTask == NULL))
     {
-        taskInterval = 50; //50 ms by default
+        //max number of allowed tasks reached
+        return TASKER_INVALID_HANDLE;
     }
 
     //check if taskStatus is valid, if not schedule
@@ -44,218 +62,146 @@ unsigned char TaskerAddTask(void (*userTask)(void),
         taskStatus = SCHEDULED;
     }
 
-    Tasks[numberTasks].taskPointer = *userTask;
-    //I get only the first 2 bits - I don't need the IMMEDIATESTART bit
-    Tasks[numberTasks].taskIsActive = taskStatus & 0x03;
-    Tasks[numberTasks].userTasksInterval = taskInterval;
-    //no wait if the user wants the task up and running once added...
-    //...otherwise we wait for the interval before to run the task
-    Tasks[numberTasks].plannedTask =
-            _counterMs + ((taskStatus & 0x04) ? 0 : taskInterval);
+    //take the first free slot
+    tempI = freeSlot;
 
-    numberTasks++;
+    if (!uKernelAddTask(&Tasks[tempI].descriptor, userTask, taskInterval,
+                        (uKernelTaskStatus) taskStatus))
+    {
+        return TASKER_INVALID_HANDLE;
+    }
 
-    return true;
+    freeSlot = Tasks[tempI].nextFree;
+
+    return ((tTaskerHandle) Tasks[tempI].generation << 8) | tempI;
 }
 
-unsigned char TaskerPauseTask(void (*userTask)(void))
+unsigned char TaskerPauseTask(tTaskerHandle handle)
 {
-    return (TaskerSetTask(userTask, PAUSED, NULL));
+    TaskerCore *task = TaskerGetTask(handle);
+
+    if (task == NULL)
+    {
+        return false;
+    }
+
+    return uKernelPauseTask(&task->descriptor);
 }
 
-unsigned char TaskerResumeTask(void (*userTask)(void))
+unsigned char TaskerResumeTask(tTaskerHandle handle)
 {
-    return (TaskerSetTask(userTask, SCHEDULED, NULL));
+    TaskerCore *task = TaskerGetTask(handle);
+
+    if (task == NULL)
+    {
+        return false;
+    }
+
+    return uKernelResumeTask(&task->descriptor);
 }
 
-unsigned char TaskerModifyTask(void (*userTask)(void),
-                               unsigned long taskInterval,
+unsigned char TaskerModifyTask(tTaskerHandle handle,
+                               uint32_t taskInterval,
                                tTaskStatus oneTimeTask)
 {
-    unsigned char tempI = 0;
-    unsigned char _done = 1;
+    TaskerCore *task = TaskerGetTask(handle);
+    uKernelTaskStatus status;
 
-    if ((oneTimeTask < SCHEDULED) && (oneTimeTask > ONETIME))
+    if (task == NULL)
     {
-        oneTimeTask = NULL;
+        return false;
     }
 
-    do
+    //only SCHEDULED and ONETIME change the status of the task
+    status = task->descriptor.taskStatus;
+    if ((oneTimeTask == SCHEDULED) || (oneTimeTask == ONETIME))
     {
-        if (Tasks[tempI].taskPointer == *userTask)
-        { //task found
-            Tasks[tempI].userTasksInterval = taskInterval;
-            if (oneTimeTask != NULL)
-            {
-                Tasks[tempI].taskIsActive = oneTimeTask;
-            }
-            Tasks[tempI].plannedTask = _counterMs + taskInterval;
-            _done = 0;
-            break;
-        }
-        tempI++;
+        status = (uKernelTaskStatus) oneTimeTask;
     }
-    while (tempI < numberTasks);
 
-    return _done;
+    return uKernelModifyTask(&task->descriptor, taskInterval, status);
 }
 
-unsigned char TaskerSetTask(void (*userTask)(void),
-                            unsigned char tempStatus,
-                            unsigned long taskInterval)
+unsigned char TaskerRemoveTask(tTaskerHandle handle)
 {
-    unsigned char tempI = 0;
+    TaskerCore *task = TaskerGetTask(handle);
+    unsigned char tempI;
 
-    if ((_initialized == 0) || (numberTasks == 0))
+    if (task == NULL)
     {
         return false;
     }
 
-    do
+    tempI = (unsigned char) (handle & 0xFF);
+
+    uKernelRemoveTask(&task->descriptor);
+    task->descriptor.taskPointer = NULL;
+    //old handles to this slot are no longer valid, 0 is never used
+    if (++task->generation == 0)
     {
-        if (Tasks[tempI].taskPointer == *userTask)
-        {
-            Tasks[tempI].taskIsActive = tempStatus;
-            if (tempStatus == SCHEDULED)
-            {
-                if (taskInterval == NULL)
-                {
-                    Tasks[tempI].plannedTask =
-                            _counterMs + Tasks[tempI].userTasksInterval;
-                }
-                else
-                {
-                    Tasks[tempI].plannedTask =
-                            _counterMs + taskInterval;
-                }
-            }
-            break;
-        }
-        else
-        {
-            tempI++;
-        }
+        task->generation = 1;
     }
-    while (tempI < numberTasks);
+
+    //give the slot back to the list of free slots
+    task->nextFree = freeSlot;
+    freeSlot = tempI;
 
     return true;
 }
 
-unsigned char TaskerRemoveTask(void (*userTask)(void))
+tTaskStatus TaskerGetTaskStatus(tTaskerHandle handle)
 {
-    unsigned char tempI = 0, tempJ;
-
-    if ((_initialized == 0) || (numberTasks == 0))
-    {
-        return false;
-    }
+    TaskerCore *task = TaskerGetTask(handle);
 
-    do
+    if (task == NULL)
     {
-        if (Tasks[tempI].taskPointer == *userTask)
-        {
-            if ((tempI + 1) == numberTasks)
-            {
-                numberTasks--;
-            }
-            else if (numberTasks > 1)
-            {
-                for (tempJ = tempI; tempJ < numberTasks; tempJ++)
-                {
-                    Tasks[tempJ].taskPointer = Tasks[tempJ + 1].taskPointer;
-                    Tasks[tempJ].taskIsActive = Tasks[tempJ + 1].taskIsActive;
-                    Tasks[tempJ].userTasksInterval =
-                            Tasks[tempJ + 1].userTasksInterval;
-                    Tasks[tempJ].plannedTask = Tasks[tempJ + 1].plannedTask;
-                }
-                numberTasks--;
-            }
-            else
-            {
-                numberTasks = 0;
-            }
-            break;
-        }
-        else
-        {
-            tempI++;
-        }
+        //return 255 if the task was not found
+        return ERROR;
     }
-    while (tempI < numberTasks);
 
-    return true;
+    //return the task status
+    return (tTaskStatus) uKernelGetTaskStatus(&task->descriptor);
 }
 
-tTaskStatus TaskerGetTaskStatus(void (*userTask)(void))
+/**
+ * Gets the slot of a task from its handle.
+ * @param handle Handle returned by TaskerAddTask.
+ * @return The slot or NULL if the handle is not valid (e.g. removed task).
+ */
+TaskerCore *TaskerGetTask(tTaskerHandle handle)
 {
-    //return 255 if the task was not found (almost impossible)
-    unsigned char tempJ = ERROR;
-    unsigned char tempI = 0;
+    unsigned char tempI = (unsigned char) (handle & 0xFF);
 
-    if ((_initialized == false) || (numberTasks == 0))
+    if ((_initialized == false) || (tempI >= MAXIMUM_TASKS))
     {
-        return false;
+        return NULL;
     }
 
-    do
+    if ((Tasks[tempI].descriptor.taskPointer == NULL)
+            || (Tasks[tempI].generation != (unsigned char) (handle >> 8)))
     {
-        if (Tasks[tempI].taskPointer == *userTask)
-        {
-            //return its current status
-            tempJ = Tasks[tempI].taskIsActive;
-            break;
-        }
-        tempI++;
+        return NULL;
     }
 
-    while (tempI < numberTasks);
-
-    return tempJ; //return the task status
+    return &Tasks[tempI];
 }
 
 void TaskerTimerInterruptHandler(void)
 {
-    _counterMs++; //increment the ms counter
+    uKernelTimerInterruptHandler(); //increment the ms counter
 }
 
-void TaskerScheduler(void)
+unsigned char TaskerSchedulerPass(void)
 {
-    unsigned char tempI = 0;
-
-    while (1)
-    {
-        if (Tasks[tempI].taskIsActive > 0)
-        { //the task is running
-            //check if it's time to execute the task
-            if ((long) (_counterMs - Tasks[tempI].plannedTask) >= 0)
-            { //this trick overrun the overflow of _counterMs
-
-                //if it's a one-time task, than it has to be removed after running
-                if (Tasks[tempI].taskIsActive == ONETIME)
-                {
-                    Tasks[tempI].taskPointer(); //call the task
-                    Tasks[tempI].taskIsActive = PAUSED;
-                }
-                else
-                {
-                    //let's schedule next start
-                    Tasks[tempI].plannedTask =
-                            _counterMs + Tasks[tempI].userTasksInterval;
-
-                    Tasks[tempI].taskPointer(); //call the task
-                }
-            }
-        }
-
-        tempI++;
+    return uKernelSchedulerPass();
+}
 
-        if (tempI >= numberTasks)
-            tempI = 0;
-    }
+void TaskerScheduler(void)
+{
+    uKernelScheduler();
 }
 
 void TaskerDelayMiliseconds(unsigned int delay)
 {
-    unsigned long newTime = _counterMs + delay;
-    while (_counterMs < newTime);
-}
\ No newline at end of file
+    uKernelDelayMiliseconds(delay);
+}
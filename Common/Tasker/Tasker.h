@@ -29,16 +29,23 @@
 #ifndef TASKER_H
 #define TASKER_H
 
+#ifndef TASKER_HOST
 #include <xc.h>
+#endif
 #include <stddef.h>
+#include <stdint.h>
 #include <stdbool.h>
+#include "../uKernel/uKernel.h"
 
 /**Tasker version*/
-#define TASKER_VERSION 112
+#define TASKER_VERSION 113
 /**Define here the maximum number of tasks to handle.*/
+#ifndef MAXIMUM_TASKS
 #define MAXIMUM_TASKS                   1
-/**Set your max interval here (max 2^32-1) - default 3600000 (1 hour)*/
-#define MAX_TASK_INTERVAL 3600000UL
+#endif
+#if MAXIMUM_TASKS > 254
+#error "MAXIMUM_TASKS must be lower than 255, the slot fits in a byte"
+#endif
 
 typedef enum
 {
@@ -56,16 +63,26 @@ typedef enum
 
 typedef struct
 {
-    /**Used to store the pointers to user's tasks*/
-    void (*taskPointer)(void);
-    /**Used to store the interval between each task's run*/
-    volatile unsigned long userTasksInterval;
-    /**Used to store the next time a task will have to be executed*/
-    volatile unsigned long plannedTask;
-    /**Used to store the status of the tasks*/
-    volatile unsigned char taskIsActive;
+    /**Descriptor of the task on the scheduler core (uKernel)*/
+    uKernelTaskDescriptor descriptor;
+    /**Incremented each time the slot is freed, invalidates old handles*/
+    unsigned char generation;
+    /**Next slot on the list of free slots*/
+    unsigned char nextFree;
 } TaskerCore;
 
+/**
+ * Handle of a task, returned by TaskerAddTask. The low byte is the slot of the
+ * task and the high byte the generation of the slot, so a handle of a removed
+ * task is never confused with a new task on the same slot.
+ */
+typedef uint16_t tTaskerHandle;
+
+/**Handle returned when the task could not be added*/
+#define TASKER_INVALID_HANDLE           0
+/**Marks the end of the list of free slots*/
+#define TASKER_NO_SLOT                  0xFF
+
 
 /**
  * This funtion as to be called before doing anything with the tasker. It
@@ -84,34 +101,35 @@ void TaskerBegin(void);
  *                   scheduling; ONETIME, for a task that has to run only once;
  *                   IMMEDIATESTART, for a task that has to be executed once it
  *                   has been added to the scheduler.
- * @return Return true if all went well, false otherwise.
+ * @return Handle of the task, TASKER_INVALID_HANDLE if the task could not be
+ *         added.
  */
-unsigned char TaskerAddTask(void (*userTask)(void),
-                            unsigned long taskInterval,
+tTaskerHandle TaskerAddTask(void (*userTask)(void),
+                            uint32_t taskInterval,
                             tTaskStatus taskStatus);
 /**
  * This funtion is used to remove the task from the scheduler.
- * @param userTask Routine to be removed.
+ * @param handle Handle of the task to be removed.
  * @return Return true if all went well, false otherwise.
  */
-unsigned char TaskerRemoveTask(void (*userTask)(void));
+unsigned char TaskerRemoveTask(tTaskerHandle handle);
 /**
  * This funtion is used to pause the task on the scheduler.
- * @param userTask Routine to be paused.
+ * @param handle Handle of the task to be paused.
  * @return Return true if all went well, false otherwise.
  */
-unsigned char TaskerPauseTask(void (*userTask)(void));
+unsigned char TaskerPauseTask(tTaskerHandle handle);
 /**
  * This funtion is used to restart a funtion that has been paused.
- * @param userTask Routine to be restarted.
+ * @param handle Handle of the task to be restarted.
  * @return Return true if all went well, false otherwise.
  */
-unsigned char TaskerResumeTask(void (*userTask)(void));
+unsigned char TaskerResumeTask(tTaskerHandle handle);
 /**
  * This funtion is used to modify a task properties, for example the running
  * interval or the type of scheduling, i.e., PAUSED, SCHEDULED, ONETIME or
  * IMMEDIATESTART.
- * @param userTask Routine to be modified.
+ * @param handle Handle of the task to be modified.
  * @param taskInterval Scheduled interval in milliseconds at which you want your
  *                     routine to be executed.
  * @param oneTimeTask Status of the task to be added to the scheduler, status can
@@ -122,30 +140,36 @@ unsigned char TaskerResumeTask(void (*userTask)(void));
  *                   has been added to the scheduler.
  * @return Return true if all went well, false otherwise.
  */
-unsigned char TaskerModifyTask(void (*userTask)(void),
-                               unsigned long taskInterval,
+unsigned char TaskerModifyTask(tTaskerHandle handle,
+                               uint32_t taskInterval,
                                tTaskStatus oneTimeTask);
 /**
  * Funtion to check if a task is running.
- * @param userTask Task to check the status.
+ * @param handle Handle of the task to check the status.
  * @return The status of the tasks.
  * @retval PAUSED Task is paused/not running.
  * @retval SCHEDULED Task is running.
  * @retval ONETIME Task is scheduled to run in a near future.
  * @retval ERROR There was an error (task not found)
  */
-tTaskStatus TaskerGetTaskStatus(void (*userTask)(void));
+tTaskStatus TaskerGetTaskStatus(tTaskerHandle handle);
 /**
  * This funtion has to be called from the timer interrut routine.
  */
 void TaskerTimerInterruptHandler(void);
+/**
+ * Runs one rotation of the scheduler, each task is checked once and executed
+ * if it is time.
+ * @return Number of tasks executed, 0 means that the scheduler is idle.
+ */
+unsigned char TaskerSchedulerPass(void);
 /**
  * Scheduler of the tasker. This funtion has to be call to the tasker to work,
  * after all the initiation on the system.
  */
 void TaskerScheduler(void);
 /**
- * Just a simple delay in miliseconds. Not related to the Tasker system.
+ * Delay in miliseconds, the other tasks keep running (see uKernelSleep).
  */
 void TaskerDelayMiliseconds(unsigned int delay);
 #endif
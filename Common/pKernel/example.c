@@ -32,12 +32,12 @@
 #include <stdlib.h>
 #include "pKernel.h"
 
-TaskDescriptor tDescriptorTask1 = {0u, 0u, NULL, NULL};
-TaskDescriptor tDescriptorTask2 = {0u, 0u, NULL, NULL};
-TaskDescriptor tDescriptorTask3 = {0u, 0u, NULL, NULL};
-TaskDescriptor tDescriptorTask4 = {0u, 0u, NULL, NULL};
-TaskDescriptor tDescriptorTask5 = {0u, 0u, NULL, NULL};
-TaskDescriptor tDescriptorTask6 = {0u, 0u, NULL, NULL};
+pKernelTaskDescriptor tDescriptorTask1;
+pKernelTaskDescriptor tDescriptorTask2;
+pKernelTaskDescriptor tDescriptorTask3;
+pKernelTaskDescriptor tDescriptorTask4;
+pKernelTaskDescriptor tDescriptorTask5;
+pKernelTaskDescriptor tDescriptorTask6;
 
 void SystemInit(void);
 
@@ -55,7 +55,7 @@ void interrupt HighIRQ(void)
         INTCONbits.TMR0IF = 0;
         TMR0H = 0xE0;
         TMR0L = 0xBE;
-        usTickCount++; // Timer for the scheduler
+        pKernelTimerInterruptHandler(); // Timer for the scheduler
     }
 }
 
@@ -68,12 +68,12 @@ void main(void)
 {
     SystemInit();
 
-    pKernelAddTask(&tDescriptorTask1, 50, Task1);
-    pKernelAddTask(&tDescriptorTask2, 100, Task2);
-    pKernelAddTask(&tDescriptorTask3, 200, Task3);
-    pKernelAddTask(&tDescriptorTask4, 50, Task4);
-    pKernelAddTask(&tDescriptorTask5, 100, Task5);
-    pKernelAddTask(&tDescriptorTask6, 200, Task6);
+    pKernelAddTask(&tDescriptorTask1, Task1, 50);
+    pKernelAddTask(&tDescriptorTask2, Task2, 100);
+    pKernelAddTask(&tDescriptorTask3, Task3, 200);
+    pKernelAddTask(&tDescriptorTask4, Task4, 50);
+    pKernelAddTask(&tDescriptorTask5, Task5, 100);
+    pKernelAddTask(&tDescriptorTask6, Task6, 200);
     pKernelScheduler();
 }
 
@@ -26,17 +26,16 @@
  *  It is willingly written in a general way to help people to
  *  customise for theirs owns applications. There are no
  *  priority between task like a round-robin task scheduling.
+ *  The scheduler itself is uKernel, this is only the pKernel API on top of it.
  */
+#ifndef PKERNEL_HOST
 #include <xc.h>
+#endif
 #include <stdio.h>
-#include <limits.h>
 #include "pKernel.h"
 
-/**Pointer of the scheduler*/
-pKernelTaskDescriptor *pTaskSchedule = NULL;
-static pKernelTaskDescriptor *pTaskFirst = NULL;
-/**Timer for the scheduler*/
-unsigned long _counterMs = 0;
+static void pKernelKeepPeriod(pKernelTaskDescriptor *pTaskDescriptor,
+                              uint32_t usPeriod);
 
 /**
  * Delete all task of the scheduler in the offing to reconfigure it. This
@@ -45,67 +44,48 @@ unsigned long _counterMs = 0;
  */
 void pKernelDeleteAllTask(void)
 {
-    pKernelAddTask(NULL, 0, NULL);
+    pKernelAddTask(NULL, NULL, 0);
 }
 
 /**
  * Add a task into the circular linked list for the scheduler.
- * @param pTaskDescriptor   Descriptor of the task
+ * @param pTaskDescriptor   Descriptor of the task, NULL to delete all tasks
  * @param usPeriod          Periodicity of the task
  * @param pTask             Function pointer on the task body
  */
-void pKernelAddTask(pKernelTaskDescriptor *pTaskDescriptor, TaskBody pTask, unsigned long usPeriod)
+void pKernelAddTask(pKernelTaskDescriptor *pTaskDescriptor, TaskBody pTask, uint32_t usPeriod)
 {
-    pKernelTaskDescriptor *pTaskWork = NULL;
-
-    if (pTaskDescriptor != NULL)
-    {
-        if (pTaskFirst != NULL)
-        {
-            // Initialize the work pointer with the scheduler pointer (never mind is current state)
-            pTaskWork = pTaskSchedule;
-            // Research the last task from the circular linked list : so research the adresse of the
-            // first task in testing the pTaskNext fields of each structure
-            while (pTaskWork->pTaskNext != pTaskFirst)
-            {
-                // Set the work pointer on the next task
-                pTaskWork = pTaskWork->pTaskNext;
-            }
-            pTaskWork->pTaskNext = pTaskDescriptor; // Insert the new task at the end of the circular linked list
+    //pKernel had no init funtion, the core is initiated with the first task,
+    //uKernelInit only does it once and keeps the time
+    uKernelInit();
 
-            pTaskDescriptor->pTaskNext = pTaskFirst; // The next task is feedback at the first task
-        }
-        else
-        {
-            // There is no task in the scheduler, this task become the First task in the circular linked list
-            pTaskFirst = pTaskDescriptor; // The pTaskFirst pointer is initialize with the first task of the scheduler
-            pTaskSchedule = pTaskFirst; // Initialize the scheduler pointer at the first task
-            pTaskDescriptor->pTaskNext = pTaskDescriptor; // The next task is itself because there is just one task in the circular linked list
-        }
-        // Common initialization for all tasks
-        pTaskDescriptor->usNext = _counterMs + usPeriod; // Initialize the task timer with the current value of usTickCount
-        pTaskDescriptor->usPeriod = usPeriod; // Set the periodicity of the task
-        pTaskDescriptor->pTask = pTask; // Set the task pointer on the task body
-    }
-    else
+    if (uKernelAddTask(pTaskDescriptor, pTask, usPeriod, UKERNEL_SCHEDULED))
     {
-        // Delete all task of the scheduler
-        // This case is necessary at the time of the call of the function DeleteAllTask()
-        pTaskFirst = NULL;
-        pTaskSchedule = NULL;
+        pKernelKeepPeriod(pTaskDescriptor, usPeriod);
     }
 }
 
+/**
+ * Remove a task from the circular linked list. It can be called by the task
+ * itself.
+ * @param pTaskDescriptor   Descriptor of the task
+ */
+void pKernelRemoveTask(pKernelTaskDescriptor *pTaskDescriptor)
+{
+    uKernelRemoveTask(pTaskDescriptor);
+}
+
 /**
  * Set the periodicity of the task
  * @param pTaskDescriptor   Descriptor of the task
  * @param usPeriod          Periodicity of the task
  */
-void pKernelResumeTask(pKernelTaskDescriptor *pTaskDescriptor, unsigned long usPeriod)
+void pKernelResumeTask(pKernelTaskDescriptor *pTaskDescriptor, uint32_t usPeriod)
 {
-    // Initialize the task timer with the current value of usTickCount
-    pTaskDescriptor->usNext = _counterMs + usPeriod;
-    pTaskDescriptor->usPeriod = usPeriod;
+    if (uKernelModifyTask(pTaskDescriptor, usPeriod, UKERNEL_SCHEDULED))
+    {
+        pKernelKeepPeriod(pTaskDescriptor, usPeriod);
+    }
 }
 
 /**
@@ -114,47 +94,71 @@ void pKernelResumeTask(pKernelTaskDescriptor *pTaskDescriptor, unsigned long usP
  */
 void pKernelSuspendTask(pKernelTaskDescriptor *pTaskDescriptor)
 {
-    pTaskDescriptor->usPeriod = ULONG_MAX;
+    uKernelPauseTask(pTaskDescriptor);
+}
+
+/**
+ * Runs one rotation of the scheduler, each task of the list is checked once
+ * and executed if it is time.
+ * @return Number of tasks executed, 0 means that the scheduler is idle.
+ */
+unsigned char pKernelSchedulerPass(void)
+{
+    return uKernelSchedulerPass();
 }
 
 /**
- * Scheduling. This runs the kernel itself.
+ * Scheduling. This runs the kernel itself. With USE_SLEEP the
+ * microcontroller sleeps when there is nothing to do.
  */
 void pKernelScheduler(void)
 {
     while (1)
     {
-        if (pTaskSchedule != NULL)
+        if (uKernelSchedulerPass() == 0)
         {
-            if (pTaskSchedule->usPeriod != ULONG_MAX)
-            {
-                if ((long) (_counterMs - pTaskSchedule->usNext) >= 0)
-                {
-                    // Initialize the task timer with the current value of usTickCount
-                    pTaskSchedule->usNext = _counterMs + pTaskSchedule->usPeriod;
-                    pTaskSchedule->pTask(); // Call the task body
-                }
-            }
-            // If a task has called the function DeleteAllTask() and if no task are added, the pointer is null
-            if (pTaskSchedule != NULL)
-            {
-                // Set the scheduler pointer on the next task
-                pTaskSchedule = pTaskSchedule->pTaskNext;
-            }
-        }
 #ifdef USE_SLEEP
-        SLEEP();
+            SLEEP();
 #endif
+        }
     }
 }
 
 /**
- * Just a simple delay in miliseconds. Not related to the Tasker system.
+ * This funtion has to be called from the timer interrupt routine.
  */
-void pKernelDelayMiliseconds(unsigned int delay)
+void pKernelTimerInterruptHandler(void)
 {
-    unsigned long newTime = _counterMs + delay;
-    while (_counterMs < newTime);
+    uKernelTimerInterruptHandler();
 }
 
+/**
+ * Delay in miliseconds, the other tasks keep running (see uKernelSleep).
+ */
+void pKernelDelayMiliseconds(unsigned int delay)
+{
+    uKernelDelayMiliseconds(delay);
+}
 
+/**
+ * uKernel replaces a period of 0 or above MAX_TASK_INTERVAL with 50 ms, pKernel
+ * takes any period and runs a task of period 0 on every pass. The releases on
+ * the grid of the period (UKERNEL_USE_GRID) need a period, there the periods
+ * of uKernel are kept.
+ * @param pTaskDescriptor   Descriptor of the task, already on the list
+ * @param usPeriod          Periodicity of the task
+ */
+static void pKernelKeepPeriod(pKernelTaskDescriptor *pTaskDescriptor,
+                              uint32_t usPeriod)
+{
+#if !UKERNEL_USE_GRID
+    if ((usPeriod < 1) || (usPeriod > MAX_TASK_INTERVAL))
+    {
+        pTaskDescriptor->userTasksInterval = usPeriod;
+        pTaskDescriptor->plannedTask = _counterMs + usPeriod;
+    }
+#else
+    (void) pTaskDescriptor;
+    (void) usPeriod;
+#endif
+}
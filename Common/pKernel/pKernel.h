@@ -26,37 +26,32 @@
  *  It is willingly written in a general way to help people to
  *  customise for theirs owns applications. There are no
  *  priority between task like a round-robin task scheduling.
+ *  The scheduler itself is uKernel, this is only the pKernel API on top of it,
+ *  build uKernel/uKernel.c together with this file. The periods are kept as
+ *  given, 0 runs the task on every pass, except with a scheduling policy other
+ *  than round robin (or microsecond or group tasks) where uKernel replaces a
+ *  period of 0 or above MAX_TASK_INTERVAL with 50 ms.
  */
 
 #ifndef _KERNEL_H
 #define _KERNEL_H
 
-//#define USE_SLEEP
-
-/**Function pointer on the task body.*/
-typedef void (*TaskBody)(void);
+#include <stdint.h>
+#include "../uKernel/uKernel.h"
 
-typedef struct _TaskDescriptor
-{
-    /**Timer of the task*/
-    unsigned long usNext;
-    /**Periodicity of the task*/
-    unsigned long usPeriod;
-    /**Function pointer on the task body*/
-    TaskBody pTask;
-    /**Pointer on the next structure task*/
-    struct _TaskDescriptor *pTaskNext;
-    /**Task Descriptor Structor*/
-} pKernelTaskDescriptor;
+//#define USE_SLEEP
 
-extern unsigned long _counterMs;
+/**The descriptors of pKernel are the descriptors of uKernel.*/
+typedef uKernelTaskDescriptor pKernelTaskDescriptor;
 
-void pKernelAddTask(pKernelTaskDescriptor *pTaskDescriptor, TaskBody pTask, unsigned long usPeriod);
+void pKernelAddTask(pKernelTaskDescriptor *pTaskDescriptor, TaskBody pTask, uint32_t usPeriod);
+void pKernelRemoveTask(pKernelTaskDescriptor *pTaskDescriptor);
 void pKernelSuspendTask(pKernelTaskDescriptor *pTaskDescriptor);
-void pKernelResumeTask(pKernelTaskDescriptor *pTaskDescriptor, unsigned long usPeriod);
+void pKernelResumeTask(pKernelTaskDescriptor *pTaskDescriptor, uint32_t usPeriod);
+unsigned char pKernelSchedulerPass(void);
 void pKernelScheduler(void);
 void pKernelDeleteAllTask(void);
+void pKernelTimerInterruptHandler(void);
 void pKernelDelayMiliseconds(unsigned int delay);
 
 #endif
-
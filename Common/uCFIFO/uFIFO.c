@@ -9,8 +9,8 @@
 
    Example Usage:
       unsigned char fifo_buf[128];
-      FIFO fifo;
-      FIFOInit(&fifo, 128, &fifo_buf[0]);
+      tFIFO fifo;
+      uFIFOInit(&fifo, &fifo_buf[0], 128);
 
  ************************************************************************/
 
@@ -18,78 +18,140 @@
 
 //This initializes the FIFO structure with the given buffer and size
 
-void uFIFOInit(tFIFO *f, unsigned char *buf, unsigned int size)
+void uFIFOInit(tFIFO *f, unsigned char *buf, UFIFO_INDEX size)
 {
     f->Head = 0;
     f->Tail = 0;
     f->Size = size;
-    f->SpaceOcupied = 0;
     f->bufferPointer = buf;
 }
 
 //This reads nbytes bytes from the FIFO
 //The number of bytes read is returned
 
-unsigned int uFIFOGet(tFIFO * f, unsigned char *buf, unsigned int nbytes)
+UFIFO_INDEX uFIFOGet(tFIFO * f, unsigned char *buf, UFIFO_INDEX nbytes)
 {
-    unsigned int i;
+    UFIFO_INDEX i;
+    UFIFO_INDEX tail = f->Tail;
 
     for (i = 0; i < nbytes; i++)
     {
-        if (f->Tail != f->Head)
+        if (tail == f->Head)
         {
-            //see if any data is available
-            *buf = f->bufferPointer[f->Tail]; //grab a byte from the buffer
+            break; //no more data
+        }
 
-            f->Tail++; //increment the tail
+        *buf++ = f->bufferPointer[tail]; //grab a byte from the buffer
 
-            if (f->Tail == f->Size)
-            {
-                //check for wrap-around
-                f->Tail = 0;
-            }
+        tail++; //increment the tail
 
-            f->SpaceOcupied--;
-        }
-        else
+        if (tail == f->Size)
         {
-            return i; //number of bytes read
+            //check for wrap-around
+            tail = 0;
         }
+
+        f->Tail = tail; //the byte is free only now
     }
 
-    return nbytes;
+    return i; //number of bytes read
 }
 
 //This writes up to nbytes bytes to the FIFO
 //If the head runs in to the tail, not all bytes are written
 //The number of bytes written is returned
 
-unsigned int uFIFOPut(tFIFO * f, unsigned char *buf, unsigned int nbytes)
+UFIFO_INDEX uFIFOPut(tFIFO * f, unsigned char *buf, UFIFO_INDEX nbytes)
 {
-    unsigned int i;
+    UFIFO_INDEX i;
+    UFIFO_INDEX head = f->Head;
+    UFIFO_INDEX next;
 
     for (i = 0; i < nbytes; i++)
     {
-        //first check to see if there is space in the buffer
-        if (f->Head + 1 == f->Tail)
+        next = head + 1;
+
+        if (next == f->Size)
         {
-            return i; //no more room
+            //check for wrap-around
+            next = 0;
         }
-        else
+
+        //first check to see if there is space in the buffer
+        if (next == f->Tail)
         {
-            f->bufferPointer[f->Head] = *buf++;
+            break; //no more room
+        }
 
-            f->Head++; //increment the head
+        f->bufferPointer[head] = *buf++;
 
-            if (f->Head == f->Size && f->Tail != 0)
-            {
-                //check for wrap-around
-                f->Head = 0;
-            }
+        head = next;
+        f->Head = head; //the byte is visible only now
+    }
 
-            f->SpaceOcupied++;
-        }
+    return i; //number of bytes written
+}
+
+//True if uFIFOPut can't write any byte
+
+bool uFIFOisFull(tFIFO *f)
+{
+    UFIFO_INDEX next = f->Head + 1;
+
+    if (next == f->Size)
+    {
+        next = 0;
+    }
+
+    return next == f->Tail;
+}
+
+//True if uFIFOGet can't read any byte
+
+bool uFIFOisEmpty(tFIFO *f)
+{
+    return f->Head == f->Tail;
+}
+
+//This returns the next byte without removing it, 0 if the FIFO is empty
+
+unsigned char uFIFOPeek(tFIFO *f)
+{
+    UFIFO_INDEX tail = f->Tail;
+
+    if (tail == f->Head)
+    {
+        return 0;
+    }
+
+    return f->bufferPointer[tail];
+}
+
+//This returns the number of bytes in the FIFO
+
+UFIFO_INDEX uFIFOSpaceOcupied(tFIFO *f)
+{
+    UFIFO_INDEX head = f->Head;
+    UFIFO_INDEX tail = f->Tail;
+
+    if (head >= tail)
+    {
+        return head - tail;
     }
 
-    return nbytes;
+    return f->Size - tail + head;
+}
+
+//This returns the number of bytes that can still be written
+
+UFIFO_INDEX uFIFOSpaceFree(tFIFO *f)
+{
+    return f->Size - 1 - uFIFOSpaceOcupied(f);
+}
+
+//This drops all the bytes, called by the consumer
+
+void uFIFOClear(tFIFO *f)
+{
+    f->Tail = f->Head;
 }
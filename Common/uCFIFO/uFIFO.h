@@ -37,6 +37,9 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  Modification History:
    Revision   Date         Author    Description of Revision
    1.00       05/30/2011   NGM       initial
+   1.01       06/20/2013   LM        fixed the wrap of uFIFOPut, single
+                                     producer/consumer safe, added the
+                                     missing functions
 
  ************************************************************************/
 #ifndef _FIFO_H_
@@ -45,25 +48,36 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /* includes */
 #include <stdbool.h>
 
+/* defines */
+//Type of the indexes. Use unsigned char on 8 bit micros (buffers of up to
+//255 bytes) so the indexes are read and written in one instruction.
+#ifndef UFIFO_INDEX
+#define UFIFO_INDEX unsigned int
+#endif
+
 /* typedefs */
+//One slot is kept free to tell a full FIFO from an empty one, a buffer of
+//size bytes holds size - 1 bytes.
+//Head is only written by uFIFOPut and Tail by uFIFOGet, so one producer and
+//one consumer (e.g. an interrupt and the main loop) need no lock.
 typedef struct
 {
     unsigned char *bufferPointer;
-    unsigned int Head;
-    unsigned int Tail;
-    unsigned int Size;
-    unsigned int SpaceOcupied;
+    volatile UFIFO_INDEX Head;
+    volatile UFIFO_INDEX Tail;
+    UFIFO_INDEX Size;
 } tFIFO;
 
 /* functions */
-void uFIFOInit(tFIFO * f, unsigned char *buf, unsigned int size);
-unsigned int uFIFOGet(tFIFO * f, unsigned char *buf, unsigned int nbytes);
-unsigned int uFIFOPut(tFIFO * f, unsigned char *buf, unsigned int nbytes);
+void uFIFOInit(tFIFO * f, unsigned char *buf, UFIFO_INDEX size);
+UFIFO_INDEX uFIFOGet(tFIFO * f, unsigned char *buf, UFIFO_INDEX nbytes);
+UFIFO_INDEX uFIFOPut(tFIFO * f, unsigned char *buf, UFIFO_INDEX nbytes);
 
 bool uFIFOisFull(tFIFO *f);
 bool uFIFOisEmpty(tFIFO *f);
 unsigned char uFIFOPeek(tFIFO *f);
-unsigned int uFIFOSpaceOcupied(tFIFO *f);
+UFIFO_INDEX uFIFOSpaceOcupied(tFIFO *f);
+UFIFO_INDEX uFIFOSpaceFree(tFIFO *f);
 void uFIFOClear(tFIFO *f);
 
 #endif // _FIFO_H_
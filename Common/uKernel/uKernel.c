@@ -12,36 +12,194 @@
  *	priority and I am tring to keep it really simple due to the memory 
  *  limitations of micrcontrollers. The maximum number of task is 255 but I am
  *  sure that the memory will go out first. If anyone needs more tasks let me know.
+ *  pKernel and Tasker are built on top of this file.
  */
  
 #include "uKernel.h"
+#if UKERNEL_USE_STATIC_TASKS
+#include "uKernelStatic.h"
+#endif
 
-uint8_t _initialized;
-uint32_t _counterMs;
-uint8_t numberTasks;
-uKernelTaskDescriptor *pTaskSchedule;
+/**Timer of the scheduler, shared by uKernel, pKernel and Tasker*/
+volatile uint32_t _counterMs;
+/**High 32 bits of the milliseconds, incremented when _counterMs overflows*/
+static volatile uint32_t counterMsHigh;
+static uint8_t _initialized;
+static uint8_t numberTasks;
+static uKernelTaskDescriptor *pTaskSchedule;
 static uKernelTaskDescriptor *pTaskFirst = NULL;
+/**Task being executed by the scheduler, NULL between tasks*/
+static uKernelTaskDescriptor *pTaskRunning = NULL;
+#if UKERNEL_USE_EVENTS
+/**Events delivered to the task that is running*/
+static uint8_t currentEvents;
+#endif
+/**Tasks waiting inside uKernelSleep, they are not run until it returns*/
+static uKernelTaskDescriptor *sleepingTasks[UKERNEL_SLEEP_NESTING];
+/**Number of nested uKernelSleep calls*/
+static uint8_t sleepDepth;
+#if UKERNEL_POOL_SIZE > 0
+/**Descriptors of the tasks created by uKernelCreateTask*/
+static uKernelTaskDescriptor taskPool[UKERNEL_POOL_SIZE];
+#endif
+#if UKERNEL_USE_DEFERRED_WORK
+/**Work deferred by the interrupts, run before the tasks*/
+static uKernelWorkItem deferredQueue[UKERNEL_DEFERRED_QUEUE_SIZE];
+/**Index of the next item to be written, only changed by uKernelDefer*/
+static volatile uint8_t deferredHead;
+/**Index of the next item to be run, only changed by the scheduler*/
+static volatile uint8_t deferredTail;
+#endif
+#if UKERNEL_USE_TRACE
+/**Ring of trace records, the oldest is overwritten*/
+static uKernelTraceRecord traceBuffer[UKERNEL_TRACE_SIZE];
+/**Index of the next record to be written*/
+static volatile uint16_t traceHead;
+/**Number of valid records on the ring*/
+static volatile uint16_t traceCount;
+/**The recording is stopped while the ring is dumped*/
+static volatile bool traceEnabled;
+/**The last pass of the scheduler was idle*/
+static bool traceIdle;
+
+#define UKERNEL_TRACE_TASK_START(pTask)                                     \
+    do                                                                      \
+    {                                                                       \
+        if (traceIdle)                                                      \
+        {                                                                   \
+            traceIdle = false;                                              \
+            uKernelTrace(UKERNEL_TRACE_IDLE_EXIT, 0);                       \
+        }                                                                   \
+        uKernelTrace(UKERNEL_TRACE_TASK_START, (pTask)->taskId);            \
+    } while (0)
+#define UKERNEL_TRACE_TASK_END(pTask)                                       \
+    uKernelTrace(UKERNEL_TRACE_TASK_END, (pTask)->taskId)
+#define UKERNEL_TRACE_POST(pTask)                                           \
+    uKernelTrace(UKERNEL_TRACE_POST, (pTask)->taskId)
+#define UKERNEL_TRACE_IDLE(executed)                                        \
+    do                                                                      \
+    {                                                                       \
+        if ((executed) == 0 && !traceIdle)                                  \
+        {                                                                   \
+            traceIdle = true;                                               \
+            uKernelTrace(UKERNEL_TRACE_IDLE_ENTER, 0);                      \
+        }                                                                   \
+    } while (0)
+#else
+#define UKERNEL_TRACE_TASK_START(pTask)
+#define UKERNEL_TRACE_TASK_END(pTask)
+#define UKERNEL_TRACE_POST(pTask)
+#define UKERNEL_TRACE_IDLE(executed)
+#endif
+#if UKERNEL_USE_TRACE || UKERNEL_USE_WATCHDOG
+/**Id of the last task added, 0 is not used*/
+static uint8_t lastTaskId;
+#endif
+#if UKERNEL_USE_WATCHDOG
+/**Id of the task that missed its check-in, 0 while all are healthy*/
+static volatile uint8_t watchdogOffender;
+/**Tick of the last check of the critical tasks*/
+static uint32_t watchdogChecked;
+
+#define UKERNEL_CHECK_IN(pTask)     ((pTask)->lastCheckIn = _counterMs)
+#else
+#define UKERNEL_CHECK_IN(pTask)
+#endif
+#if UKERNEL_SCHEDULING_POLICY != UKERNEL_POLICY_ROUND_ROBIN
+/**Sum of the utilization of the tasks with a declared WCET, 65536 is 100%*/
+static uint32_t totalUtilization;
+/**Number of tasks with a declared WCET*/
+static uint8_t admittedTasks;
+#if UKERNEL_SCHEDULING_POLICY == UKERNEL_POLICY_RATE_MONOTONIC
+
+/**Liu & Layland bound n(2^(1/n) - 1) for n = 1 to 8 tasks, 65536 is 100%
+ (the first one is only for reference, one task can use it all)*/
+static const uint16_t rateMonotonicBound[8] = {
+    65535, 54291, 51102, 49599, 48725, 48154, 47751, 47452
+};
+/**Limit of the bound for many tasks, ln(2)*/
+#define UKERNEL_RM_BOUND_LIMIT      45426
+#endif
+
+/**
+ * Deadlines of EDF further than this (about 16 minutes) are taken as equal, so
+ * the times to the deadlines in microseconds can be compared on 32 bits.
+ */
+#define UKERNEL_EDF_HORIZON_MS      1000000L
+
+static uint32_t uKernelPeriodUs(uKernelTaskDescriptor *pTask,
+                                uint32_t taskInterval);
+static uint32_t uKernelUtilization(uint16_t wcet, uint32_t periodUs);
+static bool uKernelAdmit(uint32_t utilization, uint8_t tasks);
+#endif
 
 unsigned char uKernelSetTask(uKernelTaskDescriptor *pTaskDescriptor,
                              uint32_t taskInterval,
                              uKernelTaskStatus tStatus);
+static uint32_t uKernelTaskTime(uKernelTaskDescriptor *pTask);
+
+/**The releases of the task are kept on the grid of its period*/
+#if UKERNEL_SCHEDULING_POLICY != UKERNEL_POLICY_ROUND_ROBIN
+#define UKERNEL_ON_GRID(pTask)      true
+#elif UKERNEL_USE_MICROSECONDS && UKERNEL_USE_GROUPS
+#define UKERNEL_ON_GRID(pTask)      ((pTask)->microseconds || (pTask)->aligned)
+#elif UKERNEL_USE_MICROSECONDS
+#define UKERNEL_ON_GRID(pTask)      ((pTask)->microseconds)
+#elif UKERNEL_USE_GROUPS
+#define UKERNEL_ON_GRID(pTask)      ((pTask)->aligned)
+#else
+#define UKERNEL_ON_GRID(pTask)      false
+#endif
 
 /**
  * This funtion as to be called before doing anything with the tasker. It
  * initiates the tasker subsystems. If this funtion is not called before doing
  * anything with the tasker all funtions will return false.
+ * The core is shared by uKernel, pKernel and Tasker, so only the first call
+ * does something, the next ones keep the tasks. The time is never reset, it
+ * may have been set before (e.g. KernelHostSetTime), use uKernelRemoveAllTasks
+ * to clear the list.
  */
 void uKernelInit(void)
 {
+    if (_initialized)
+    {
+        return;
+    }
+
     _initialized = true;
-    _counterMs = 0;
     numberTasks = 0;
     pTaskSchedule = NULL;
+    pTaskFirst = NULL;
+    sleepDepth = 0;
+#if UKERNEL_USE_DEFERRED_WORK
+    deferredHead = 0;
+    deferredTail = 0;
+#endif
+#if UKERNEL_SCHEDULING_POLICY != UKERNEL_POLICY_ROUND_ROBIN
+    totalUtilization = 0;
+    admittedTasks = 0;
+#endif
+#if UKERNEL_USE_TRACE || UKERNEL_USE_WATCHDOG
+    lastTaskId = 0;
+#endif
+#if UKERNEL_USE_WATCHDOG
+    watchdogOffender = 0;
+    watchdogChecked = 0;
+#endif
+#if UKERNEL_USE_TRACE
+    traceIdle = false;
+    uKernelTraceClear();
+#endif
+#if UKERNEL_USE_STATIC_TASKS
+    uKernelStaticInit();
+#endif
 }
 
 /**
  * Add a task into the circular linked list for the scheduler.
- * @param pTaskDescriptor   Descriptor of the task.
+ * @param pTaskDescriptor   Descriptor of the task, zeroed before its first add
+ *                          (static storage), see onList.
  * @param userTask          Function pointer on the task body
  * @param taskInterval Scheduled interval in milliseconds at which you want your
  *                     routine to be executed.
@@ -52,7 +210,8 @@ void uKernelInit(void)
  *                   IMMEDIATESTART, for a task that has to be executed once it
  *                   has been added to the scheduler; ONETIME_IMMEDIATESTART, for
  *                   a task that as to be executed now and it will only be
- *                   executed one time.
+ *                   executed one time; WAITEVENT, for a task that only runs
+ *                   when an event or a message is posted to it.
  * @return True or False
  * @see @uKernelTaskStatus
  */
@@ -61,7 +220,40 @@ bool uKernelAddTask(uKernelTaskDescriptor *pTaskDescriptor,
                     uint32_t taskInterval,
                     uKernelTaskStatus taskStatus)
 {
-    uKernelTaskDescriptor *pTaskWork = NULL;
+#if UKERNEL_SCHEDULING_POLICY != UKERNEL_POLICY_ROUND_ROBIN
+    return uKernelAddTaskWithWCET(pTaskDescriptor, userTask, taskInterval,
+                                  taskStatus, 0);
+}
+
+/**
+ * Add a task with its worst case execution time. The task is only added if
+ * the utilization of all the tasks with a WCET stays under the bound of the
+ * scheduling policy.
+ * @param pTaskDescriptor   Descriptor of the task.
+ * @param userTask          Function pointer on the task body
+ * @param taskInterval Period of the task in milliseconds, it is also the
+ *                     relative deadline.
+ * @param taskStatus Status of the task, see uKernelAddTask.
+ * @param wcet Worst case execution time in microseconds, 0 if the task is not
+ *             part of the admission check.
+ * @return Return true if all went well, false otherwise (e.g. the task set
+ *         would not be schedulable).
+ */
+bool uKernelAddTaskWithWCET(uKernelTaskDescriptor *pTaskDescriptor,
+                            TaskBody userTask,
+                            uint32_t taskInterval,
+                            uKernelTaskStatus taskStatus,
+                            uint16_t wcet)
+{
+    uint32_t utilization = 0;
+#endif
+    uKernelTaskDescriptor *pTaskLast = NULL;
+
+    if (pTaskDescriptor == NULL)
+    {
+        // This case is necessary at the time of the call of the function DeleteAllTask()
+        return uKernelRemoveAllTasks();
+    }
 
     if ((_initialized == false) || (numberTasks == MAX_TASKS_NUMBER)
             || (userTask == NULL))
@@ -69,107 +261,439 @@ bool uKernelAddTask(uKernelTaskDescriptor *pTaskDescriptor,
         return false;
     }
 
+    // The task is already on the list
+    if (pTaskDescriptor->onList)
+    {
+        return false;
+    }
+
     if ((taskInterval < 1) || (taskInterval > MAX_TASK_INTERVAL))
     {
         taskInterval = 50; //50 ms by default
     }
 
     //check if taskStatus is valid, if not schedule
-    if (taskStatus > UKERNEL_ONETIME_IMMEDIATESTART)
+    if (taskStatus > UKERNEL_WAITEVENT)
     {
         taskStatus = UKERNEL_SCHEDULED;
     }
 
-    if (pTaskDescriptor != NULL)
+#if UKERNEL_SCHEDULING_POLICY != UKERNEL_POLICY_ROUND_ROBIN
+    if (wcet != 0)
     {
-        if (pTaskFirst != NULL)
-        {
-            // Initialize the work pointer with the scheduler pointer (never mind is current state)
-            pTaskWork = pTaskSchedule;
-            // Research the last task from the circular linked list : so research the adresse of the
-            // first task in testing the pTaskNext fields of each structure
-            while (pTaskWork->pTaskNext != pTaskFirst)
-            {
-                // Set the work pointer on the next task
-                pTaskWork = pTaskWork->pTaskNext;
-            }
-            pTaskWork->pTaskNext = pTaskDescriptor; // Insert the new task at the end of the circular linked list
+        utilization = uKernelUtilization(wcet, taskInterval * 1000UL);
 
-            pTaskDescriptor->pTaskNext = pTaskFirst; // The next task is feedback at the first task
-        }
-        else
+        if (!uKernelAdmit(totalUtilization + utilization, admittedTasks + 1))
         {
-            // There is no task in the scheduler, this task become the First task in the circular linked list
-            pTaskFirst = pTaskDescriptor; // The pTaskFirst pointer is initialize with the first task of the scheduler
-            pTaskSchedule = pTaskFirst; // Initialize the scheduler pointer at the first task
-            pTaskDescriptor->pTaskNext = pTaskDescriptor; // The next task is itself because there is just one task in the circular linked list
+            return false;
         }
-        // Common initialization for all tasks
-        // no wait if the user wants the task up and running once added...
-        //...otherwise we wait for the interval before to run the task
-        pTaskDescriptor->plannedTask =
-                _counterMs + ((taskStatus & 0x04) ? 0 : taskInterval);
 
-        // Set the periodicity of the task
-        pTaskDescriptor->userTasksInterval = taskInterval;
-        // Set the task pointer on the task body
-        pTaskDescriptor->taskPointer = userTask;
-        //I get only the first 2 bits - I don't need the IMMEDIATESTART bit
-        pTaskDescriptor->taskStatus = taskStatus & 0x03;
-
-        numberTasks++;
+        totalUtilization += utilization;
+        admittedTasks++;
+    }
+    pTaskDescriptor->wcet = wcet;
+#endif
+#if UKERNEL_SCHEDULING_POLICY == UKERNEL_POLICY_FIXED_PRIORITY
+    pTaskDescriptor->priority = 0;
+#endif
+#if UKERNEL_USE_MICROSECONDS
+    pTaskDescriptor->microseconds = false;
+#endif
+#if UKERNEL_USE_GROUPS
+    pTaskDescriptor->aligned = false;
+#endif
 
-        return true;
+    if (pTaskFirst != NULL)
+    {
+        // The last task of the circular linked list is the previous of the first
+        pTaskLast = pTaskFirst->pTaskPrevious;
+        // Insert the new task at the end of the circular linked list
+        pTaskLast->pTaskNext = pTaskDescriptor;
+        pTaskDescriptor->pTaskPrevious = pTaskLast;
+        // The next task is feedback at the first task
+        pTaskDescriptor->pTaskNext = pTaskFirst;
+        pTaskFirst->pTaskPrevious = pTaskDescriptor;
     }
     else
     {
-        // Delete all task of the scheduler
-        // This case is necessary at the time of the call of the function DeleteAllTask()
-        pTaskFirst = NULL;
-        pTaskSchedule = NULL;
+        // There is no task in the scheduler, this task become the First task in the circular linked list
+        pTaskFirst = pTaskDescriptor; // The pTaskFirst pointer is initialize with the first task of the scheduler
+        pTaskSchedule = pTaskFirst; // Initialize the scheduler pointer at the first task
+        pTaskDescriptor->pTaskNext = pTaskDescriptor; // The next task is itself because there is just one task in the circular linked list
+        pTaskDescriptor->pTaskPrevious = pTaskDescriptor;
+    }
+    // Common initialization for all tasks
+    // no wait if the user wants the task up and running once added...
+    //...otherwise we wait for the interval before to run the task
+    pTaskDescriptor->plannedTask =
+            _counterMs + ((taskStatus & 0x04) ? 0 : taskInterval);
 
-        return true;
+    // Set the periodicity of the task
+    pTaskDescriptor->userTasksInterval = taskInterval;
+    // Set the task pointer on the task body
+    pTaskDescriptor->taskPointer = userTask;
+    //I don't need the IMMEDIATESTART bit
+    pTaskDescriptor->taskStatus = taskStatus & ~0x04;
+#if UKERNEL_USE_EVENTS
+    pTaskDescriptor->eventFlags = 0;
+    pTaskDescriptor->mailboxHead = 0;
+    pTaskDescriptor->mailboxTail = 0;
+#endif
+#if UKERNEL_USE_COROUTINES
+    pTaskDescriptor->coroutineLine = 0;
+#if UKERNEL_USE_GRID
+    pTaskDescriptor->coroutineWaiting = false;
+#endif
+#endif
+#if UKERNEL_USE_WATCHDOG
+    pTaskDescriptor->watchdogTimeout = 0;
+    pTaskDescriptor->lastCheckIn = _counterMs;
+#endif
+#if UKERNEL_USE_TRACE || UKERNEL_USE_WATCHDOG
+    // 0 is kept for the records that are not about a task
+    if (++lastTaskId == 0)
+    {
+        lastTaskId = 1;
     }
+    pTaskDescriptor->taskId = lastTaskId;
+#endif
+#if UKERNEL_USE_STATISTICS
+    pTaskDescriptor->releases = 0;
+    pTaskDescriptor->deadlineMisses = 0;
+#endif
+
+    pTaskDescriptor->onList = true;
+    numberTasks++;
+
+    return true;
 }
 
 /**
- * This funtion is used to remove the task from the scheduler.
+ * This funtion is used to remove the task from the scheduler. It can be called
+ * by the task itself.
  * @param pTaskDescriptor Descriptor of the task to be removed.
- * @return Return true if all went well, false otherwise.
+ * @return Return true if all went well, false otherwise (e.g. the task isn't
+ *         on the scheduler).
  */
 bool uKernelRemoveTask(uKernelTaskDescriptor *pTaskDescriptor)
 {
-    uKernelTaskDescriptor *pTaskCurr = NULL;
-
     if ((_initialized == false) || (numberTasks == 0) ||
             pTaskDescriptor == NULL)
     {
         return false;
     }
 
-    // Initialize the work pointer with the scheduler pointer (never mind is current state)
-    pTaskCurr = pTaskFirst;
-
-    while (pTaskCurr->pTaskNext != pTaskDescriptor)
+    // The task is not on the list
+    if (!pTaskDescriptor->onList)
     {
-        // Set the work pointer on the next task
-        pTaskCurr = pTaskCurr->pTaskNext;
+        return false;
     }
 
-    if (pTaskCurr->pTaskNext == pTaskFirst)
+    if (pTaskDescriptor->pTaskNext == pTaskDescriptor)
     {
-        pTaskFirst = pTaskCurr->pTaskNext->pTaskNext;
+        // It was the only task
+        pTaskFirst = NULL;
+        pTaskSchedule = NULL;
     }
     else
     {
-        pTaskCurr->pTaskNext = pTaskDescriptor->pTaskNext;
+        pTaskDescriptor->pTaskPrevious->pTaskNext = pTaskDescriptor->pTaskNext;
+        pTaskDescriptor->pTaskNext->pTaskPrevious = pTaskDescriptor->pTaskPrevious;
+
+        if (pTaskFirst == pTaskDescriptor)
+        {
+            pTaskFirst = pTaskDescriptor->pTaskNext;
+        }
+
+        // The scheduler moves to the next task of the removed one
+        if (pTaskSchedule == pTaskDescriptor)
+        {
+            pTaskSchedule = pTaskDescriptor->pTaskPrevious;
+        }
+    }
+
+    pTaskDescriptor->pTaskNext = NULL;
+    pTaskDescriptor->pTaskPrevious = NULL;
+    pTaskDescriptor->onList = false;
+#if UKERNEL_POOL_SIZE > 0
+    // A descriptor of the pool goes back to the pool
+    if ((pTaskDescriptor >= &taskPool[0])
+            && (pTaskDescriptor < &taskPool[UKERNEL_POOL_SIZE]))
+    {
+        pTaskDescriptor->taskPointer = NULL;
+    }
+#endif
+
+#if UKERNEL_SCHEDULING_POLICY != UKERNEL_POLICY_ROUND_ROBIN
+    if (pTaskDescriptor->wcet != 0)
+    {
+        totalUtilization -= uKernelUtilization(pTaskDescriptor->wcet,
+                uKernelPeriodUs(pTaskDescriptor,
+                                pTaskDescriptor->userTasksInterval));
+        admittedTasks--;
     }
+#endif
 
     numberTasks--;
 
     return true;
 }
 
+/**
+ * Delete all task of the scheduler in the offing to reconfigure it.
+ * @return Return true if all went well, false otherwise.
+ */
+bool uKernelRemoveAllTasks(void)
+{
+    uKernelTaskDescriptor *pTaskWork;
+#if UKERNEL_POOL_SIZE > 0
+    uint8_t index;
+#endif
+
+    if (_initialized == false)
+    {
+        return false;
+    }
+
+    while (pTaskFirst != NULL)
+    {
+        pTaskWork = pTaskFirst;
+        pTaskFirst = (pTaskWork->pTaskNext == pTaskWork) ? NULL : pTaskWork->pTaskNext;
+        pTaskWork->pTaskNext = NULL;
+        pTaskWork->pTaskPrevious = NULL;
+        pTaskWork->onList = false;
+    }
+#if UKERNEL_POOL_SIZE > 0
+    for (index = 0; index < UKERNEL_POOL_SIZE; index++)
+    {
+        taskPool[index].taskPointer = NULL;
+    }
+#endif
+
+    pTaskSchedule = NULL;
+    numberTasks = 0;
+#if UKERNEL_SCHEDULING_POLICY != UKERNEL_POLICY_ROUND_ROBIN
+    totalUtilization = 0;
+    admittedTasks = 0;
+#endif
+
+    return true;
+}
+
+#if UKERNEL_USE_MICROSECONDS
+
+/**
+ * Add a task with a period in microseconds, e.g. to sample a sensor at a few
+ * kHz. The task is checked on every pass of the scheduler, against
+ * uKernelGetTimeUs(), and its runs stay on the grid of the period.
+ * @param pTaskDescriptor   Descriptor of the task.
+ * @param userTask          Function pointer on the task body
+ * @param taskInterval Period in microseconds (up to MAX_TASK_INTERVAL).
+ * @param taskStatus Status of the task, see uKernelAddTask.
+ * @return True or False
+ */
+bool uKernelAddTaskMicroseconds(uKernelTaskDescriptor *pTaskDescriptor,
+                                TaskBody userTask,
+                                uint32_t taskInterval,
+                                uKernelTaskStatus taskStatus)
+{
+#if UKERNEL_SCHEDULING_POLICY != UKERNEL_POLICY_ROUND_ROBIN
+    return uKernelAddTaskMicrosecondsWithWCET(pTaskDescriptor, userTask,
+                                              taskInterval, taskStatus, 0);
+}
+
+/**
+ * Add a task with a period in microseconds and its worst case execution time,
+ * see uKernelAddTaskWithWCET. The admission check uses the period in
+ * microseconds.
+ * @param pTaskDescriptor   Descriptor of the task.
+ * @param userTask          Function pointer on the task body
+ * @param taskInterval Period in microseconds (up to MAX_TASK_INTERVAL), it is
+ *                     also the relative deadline.
+ * @param taskStatus Status of the task, see uKernelAddTask.
+ * @param wcet Worst case execution time in microseconds, 0 if the task is not
+ *             part of the admission check.
+ * @return Return true if all went well, false otherwise (e.g. the task set
+ *         would not be schedulable).
+ */
+bool uKernelAddTaskMicrosecondsWithWCET(uKernelTaskDescriptor *pTaskDescriptor,
+                                        TaskBody userTask,
+                                        uint32_t taskInterval,
+                                        uKernelTaskStatus taskStatus,
+                                        uint16_t wcet)
+{
+    uint32_t utilization;
+#endif
+    if ((pTaskDescriptor == NULL)
+            || !uKernelAddTask(pTaskDescriptor, userTask, taskInterval,
+                               taskStatus))
+    {
+        return false;
+    }
+
+    pTaskDescriptor->microseconds = true;
+    pTaskDescriptor->plannedTask = (uint32_t) uKernelGetTimeUs()
+            + ((taskStatus & 0x04) ? 0 : pTaskDescriptor->userTasksInterval);
+
+#if UKERNEL_SCHEDULING_POLICY != UKERNEL_POLICY_ROUND_ROBIN
+    // The period is only known in microseconds now, admit the task with it
+    if (wcet != 0)
+    {
+        utilization = uKernelUtilization(wcet,
+                                         pTaskDescriptor->userTasksInterval);
+
+        if (!uKernelAdmit(totalUtilization + utilization, admittedTasks + 1))
+        {
+            uKernelRemoveTask(pTaskDescriptor);
+            return false;
+        }
+
+        totalUtilization += utilization;
+        admittedTasks++;
+        pTaskDescriptor->wcet = wcet;
+    }
+#endif
+
+    return true;
+}
+
+#endif
+
+#if UKERNEL_USE_GROUPS
+
+/**
+ * Adds a task to the group of its period and phase, see uKernelAlignTask.
+ * @param pTaskDescriptor Descriptor of the task.
+ * @param userTask Function pointer on the task body.
+ * @param taskInterval Period of the group in milliseconds.
+ * @param phase Offset of the releases inside the period in milliseconds.
+ * @param taskStatus Status of the task, an IMMEDIATESTART task still waits for
+ *                   the first release of its group.
+ * @return Return true if all went well, false otherwise.
+ */
+bool uKernelAddGroupTask(uKernelTaskDescriptor *pTaskDescriptor,
+                         void (*userTask)(void),
+                         uint32_t taskInterval,
+                         uint32_t phase,
+                         uKernelTaskStatus taskStatus)
+{
+    return uKernelAddTask(pTaskDescriptor, userTask, taskInterval, taskStatus)
+            && uKernelAlignTask(pTaskDescriptor, phase);
+}
+
+/**
+ * Moves the next release of a task to the grid k * period + phase of the time
+ * base and keeps it there (no drift), so the tasks with the same period and
+ * phase run in the same wakeup. Call it again after uKernelModifyTask.
+ * @param pTaskDescriptor Descriptor of the task.
+ * @param phase Offset of the releases inside the period in milliseconds.
+ * @return Return true if all went well, false otherwise (e.g. the task has a
+ *         period in microseconds or a period out of 1..MAX_TASK_INTERVAL).
+ */
+bool uKernelAlignTask(uKernelTaskDescriptor *pTaskDescriptor, uint32_t phase)
+{
+    uint32_t now;
+    uint32_t period;
+    uint8_t interruptState;
+
+    if (!_initialized || pTaskDescriptor == NULL)
+    {
+        return false;
+    }
+
+#if UKERNEL_USE_MICROSECONDS
+    if (pTaskDescriptor->microseconds)
+    {
+        return false;
+    }
+#endif
+
+    //the grid restarts when _counterMs overflows (every 49 days), tasks
+    //aligned after that can be off their group by 2^32 % period
+    now = _counterMs;
+    period = pTaskDescriptor->userTasksInterval;
+
+    //same periods as uKernelAddTask, e.g. not a descriptor never added
+    if ((period < 1) || (period > MAX_TASK_INTERVAL))
+    {
+        return false;
+    }
+
+    phase %= period;
+
+    UKERNEL_DISABLE_INTERRUPTS(interruptState);
+    pTaskDescriptor->plannedTask = now
+            + (phase + period - now % period) % period;
+    pTaskDescriptor->aligned = true;
+#if UKERNEL_USE_COROUTINES
+    pTaskDescriptor->coroutineWaiting = false;
+#endif
+    UKERNEL_ENABLE_INTERRUPTS(interruptState);
+
+    return true;
+}
+
+#endif
+
+#if UKERNEL_POOL_SIZE > 0
+
+/**
+ * Takes a descriptor from the pool of the kernel and adds the task with it.
+ * The descriptor goes back to the pool when the task is removed.
+ * @param userTask Function pointer on the task body
+ * @param taskInterval Scheduled interval in milliseconds.
+ * @param taskStatus Status of the task, see uKernelAddTask.
+ * @return The descriptor of the task, NULL if the pool is empty.
+ */
+uKernelTaskDescriptor *uKernelCreateTask(TaskBody userTask,
+                                         uint32_t taskInterval,
+                                         uKernelTaskStatus taskStatus)
+{
+    uint8_t index;
+
+    for (index = 0; index < UKERNEL_POOL_SIZE; index++)
+    {
+        // Free descriptors of the pool have no task body
+        if (taskPool[index].taskPointer == NULL)
+        {
+            if (!uKernelAddTask(&taskPool[index], userTask, taskInterval,
+                                taskStatus))
+            {
+                return NULL;
+            }
+
+            return &taskPool[index];
+        }
+    }
+
+    return NULL;
+}
+
+#endif
+
+#if UKERNEL_SCHEDULING_POLICY == UKERNEL_POLICY_FIXED_PRIORITY
+
+/**
+ * Sets the priority of a task, the tasks are added with priority 0.
+ * @param pTaskDescriptor Descriptor of the task.
+ * @param priority Priority of the task, 0 is the highest.
+ * @return Return true if all went well, false otherwise.
+ */
+bool uKernelSetTaskPriority(uKernelTaskDescriptor *pTaskDescriptor,
+                            uint8_t priority)
+{
+    if ((_initialized == false) || (pTaskDescriptor == NULL))
+    {
+        return false;
+    }
+
+    pTaskDescriptor->priority = priority;
+
+    return true;
+}
+
+#endif
+
 /**
  * This funtion is used to pause the task on the scheduler.
  * @param pTaskDescriptor Descriptor of the task to be paused.
@@ -177,7 +701,7 @@ bool uKernelRemoveTask(uKernelTaskDescriptor *pTaskDescriptor)
  */
 bool uKernelPauseTask(uKernelTaskDescriptor *pTaskDescriptor)
 {
-    return (uKernelSetTask(pTaskDescriptor, NULL, UKERNEL_PAUSED));
+    return (uKernelSetTask(pTaskDescriptor, 0, UKERNEL_PAUSED));
 }
 
 /**
@@ -187,7 +711,7 @@ bool uKernelPauseTask(uKernelTaskDescriptor *pTaskDescriptor)
  */
 bool uKernelResumeTask(uKernelTaskDescriptor *pTaskDescriptor)
 {
-    return (uKernelSetTask(pTaskDescriptor, NULL, UKERNEL_SCHEDULED));
+    return (uKernelSetTask(pTaskDescriptor, 0, UKERNEL_SCHEDULED));
 }
 
 /**
@@ -216,17 +740,47 @@ bool uKernelModifyTask(uKernelTaskDescriptor *pTaskDescriptor,
         return false;
     }
 
-    if (tStatus > UKERNEL_ONETIME_IMMEDIATESTART)
+    if (tStatus > UKERNEL_WAITEVENT)
     {
         return false;
     }
 
+    if ((taskInterval < 1) || (taskInterval > MAX_TASK_INTERVAL))
+    {
+        taskInterval = 50; //50 ms by default, as in uKernelAddTask
+    }
+
+#if UKERNEL_SCHEDULING_POLICY != UKERNEL_POLICY_ROUND_ROBIN
+    // A new period changes the utilization, check it again
+    if ((pTaskDescriptor->wcet != 0)
+            && (taskInterval != pTaskDescriptor->userTasksInterval))
+    {
+        uint32_t utilization = totalUtilization
+                - uKernelUtilization(pTaskDescriptor->wcet,
+                uKernelPeriodUs(pTaskDescriptor,
+                                pTaskDescriptor->userTasksInterval))
+                + uKernelUtilization(pTaskDescriptor->wcet,
+                uKernelPeriodUs(pTaskDescriptor, taskInterval));
+
+        if (!uKernelAdmit(utilization, admittedTasks))
+        {
+            return false;
+        }
+
+        totalUtilization = utilization;
+    }
+#endif
+
     pTaskDescriptor->userTasksInterval = taskInterval;
     pTaskDescriptor->taskStatus = tStatus;
+#if UKERNEL_USE_COROUTINES && UKERNEL_USE_GRID
+    pTaskDescriptor->coroutineWaiting = false;
+#endif
 
     if (tStatus == UKERNEL_SCHEDULED || tStatus == UKERNEL_ONETIME)
     {
-        pTaskDescriptor->plannedTask = _counterMs + taskInterval;
+        pTaskDescriptor->plannedTask =
+                uKernelTaskTime(pTaskDescriptor) + taskInterval;
     }
     else
     {
@@ -257,78 +811,1216 @@ uKernelTaskStatus uKernelGetTaskStatus(uKernelTaskDescriptor *pTaskDescriptor)
 }
 
 /**
- * Scheduling. This runs the kernel itself.
+ * Returns the descriptor of the task that is running. Useful for a task body
+ * to know its own descriptor.
+ * @return The descriptor of the running task.
  */
-void uKernelScheduler(void)
+uKernelTaskDescriptor *uKernelGetCurrentTask(void)
 {
-    while (1)
+    return pTaskRunning;
+}
+
+#if UKERNEL_USE_COROUTINES
+
+/**
+ * Sets when a coroutine continues, used by the waits of uKernelCoroutine.h.
+ * The time is taken in the time base of the task and the next release of a
+ * task on a grid is kept apart, so the wait doesn't move the grid.
+ * @param pTaskDescriptor Descriptor of the task.
+ * @param milliseconds Time to wait, 0 to continue on the next pass.
+ */
+void uKernelCoroutineWait(uKernelTaskDescriptor *pTaskDescriptor,
+                          uint32_t milliseconds)
+{
+#if UKERNEL_USE_GRID
+    if (UKERNEL_ON_GRID(pTaskDescriptor) && !pTaskDescriptor->coroutineWaiting)
     {
-        if (pTaskSchedule != NULL && numberTasks != 0)
-        {
-            //the task is running
-            if (pTaskSchedule->taskStatus > UKERNEL_PAUSED)
-            {
-                //this trick overrun the overflow of _counterMs
-                if ((long) (_counterMs - pTaskSchedule->plannedTask) >= 0)
-                {
-                    if (pTaskSchedule->taskStatus & UKERNEL_ONETIME)
-                    {
-                        pTaskSchedule->taskPointer(); //call the task
-                        pTaskSchedule->taskStatus = UKERNEL_PAUSED; //pause the task
-                    }
-                    else
-                    {
-                        //let's schedule next start
-                        pTaskSchedule->plannedTask =
-                                _counterMs + pTaskSchedule->userTasksInterval;
-
-                        pTaskSchedule->taskPointer(); //call the task
-                    }
-                }
-            }
-            // If a task has called the function DeleteAllTask() and if no
-            // task are added, the pointer is null
-            if (pTaskSchedule != NULL)
-            {
-                // Set the scheduler pointer on the next task
-                pTaskSchedule = pTaskSchedule->pTaskNext;
-            }
-        }
+        pTaskDescriptor->coroutineRelease = pTaskDescriptor->plannedTask;
+        pTaskDescriptor->coroutineWaiting = true;
+    }
+#endif
+#if UKERNEL_USE_MICROSECONDS
+    if (pTaskDescriptor->microseconds)
+    {
+        milliseconds *= 1000;
     }
+#endif
+
+    pTaskDescriptor->plannedTask = uKernelTaskTime(pTaskDescriptor)
+            + milliseconds;
 }
 
+#endif
+
 /**
- * Just a simple delay in miliseconds. Not related to the Tasker system.
+ * Walks the list of tasks, e.g. to print the statistics.
+ * @param pTaskDescriptor Descriptor of a task, NULL to get the first task.
+ * @return The task after the given one, NULL after the last task.
  */
-void uKernelDelayMiliseconds(unsigned int delay)
+uKernelTaskDescriptor *uKernelGetNextTask(uKernelTaskDescriptor *pTaskDescriptor)
 {
-    unsigned long newTime = _counterMs + delay;
-    while (_counterMs < newTime);
+    if (pTaskDescriptor == NULL)
+    {
+        return pTaskFirst;
+    }
+
+    if ((pTaskDescriptor->pTaskNext == NULL)
+            || (pTaskDescriptor->pTaskNext == pTaskFirst))
+    {
+        return NULL;
+    }
+
+    return pTaskDescriptor->pTaskNext;
 }
 
-unsigned char uKernelSetTask(uKernelTaskDescriptor *pTaskDescriptor,
-                             uint32_t taskInterval,
-                             uKernelTaskStatus tStatus)
+#if UKERNEL_SCHEDULING_POLICY != UKERNEL_POLICY_ROUND_ROBIN
+
+/**
+ * Gets the utilization of the tasks with a declared WCET.
+ * @return The utilization, 65536 is 100%.
+ */
+uint32_t uKernelGetUtilization(void)
 {
-    if ((_initialized == false) || (numberTasks == MAX_TASKS_NUMBER)
-            || (pTaskDescriptor == NULL))
+    return totalUtilization;
+}
+
+/**
+ * Period of a task in microseconds, the unit of the utilizations and of the
+ * priority keys, whatever the time base of the task.
+ * @param pTask Descriptor of the task.
+ * @param taskInterval Period in the time base of the task.
+ * @return The period in microseconds, MAX_TASK_INTERVAL ms still fits.
+ */
+static uint32_t uKernelPeriodUs(uKernelTaskDescriptor *pTask,
+                                uint32_t taskInterval)
+{
+#if UKERNEL_USE_MICROSECONDS
+    if (pTask->microseconds)
     {
-        return false;
+        return taskInterval;
     }
+#else
+    (void) pTask;
+#endif
 
-    pTaskDescriptor->taskStatus = tStatus;
+    return taskInterval * 1000UL;
+}
 
-    if (tStatus == UKERNEL_SCHEDULED)
+/**
+ * Utilization of a task, rounded up so the check stays on the safe side.
+ * @param wcet Worst case execution time in microseconds.
+ * @param periodUs Period in microseconds.
+ * @return wcet / period, 65536 is 100%.
+ */
+static uint32_t uKernelUtilization(uint16_t wcet, uint32_t periodUs)
+{
+    // 2^16 * 65535 still fits in 32 bits
+    uint32_t scaled = (uint32_t) wcet << 16;
+    uint32_t utilization;
+
+    if (periodUs == 0)
     {
-        if (taskInterval == NULL)
-        {
-            pTaskDescriptor->plannedTask =
-                    _counterMs + pTaskDescriptor->userTasksInterval;
+        return UINT32_MAX >> 1;
+    }
+
+    utilization = scaled / periodUs;
+    if ((scaled % periodUs) != 0)
+    {
+        utilization++;
+    }
+
+    return utilization;
+}
+
+/**
+ * Schedulability test of the policy.
+ * @param utilization Utilization of the task set, 65536 is 100%.
+ * @param tasks Number of tasks of the set.
+ * @return True if the task set can be scheduled.
+ */
+static bool uKernelAdmit(uint32_t utilization, uint8_t tasks)
+{
+#if UKERNEL_SCHEDULING_POLICY != UKERNEL_POLICY_RATE_MONOTONIC
+    (void) tasks;
+
+    return utilization <= 65536UL;
+#else
+    if (tasks == 1)
+    {
+        return utilization <= 65536UL;
+    }
+
+    if (tasks <= 8)
+    {
+        return utilization <= rateMonotonicBound[tasks - 1];
+    }
+
+    return utilization <= UKERNEL_RM_BOUND_LIMIT;
+#endif
+}
+
+#endif
+
+#if UKERNEL_USE_EVENTS
+
+/**
+ * Posts events to a task. The task will run on the next pass of the scheduler,
+ * even if it isn't time yet or it is waiting for events. Can be called from an
+ * interrupt.
+ * @param pTaskDescriptor Descriptor of the task.
+ * @param events Event flags to be set, bit 7 (UKERNEL_EVENT_MESSAGE) is
+ *               reserved for the kernel.
+ */
+void uKernelPostEvent(uKernelTaskDescriptor *pTaskDescriptor, uint8_t events)
+{
+    uint8_t interruptState;
+
+    if (pTaskDescriptor == NULL)
+    {
+        return;
+    }
+
+    UKERNEL_DISABLE_INTERRUPTS(interruptState);
+    pTaskDescriptor->eventFlags |= events;
+    UKERNEL_ENABLE_INTERRUPTS(interruptState);
+
+    UKERNEL_TRACE_POST(pTaskDescriptor);
+}
+
+/**
+ * Posts a message to the mailbox of a task. The task will run on the next pass
+ * of the scheduler. Can be called from an interrupt.
+ * @param pTaskDescriptor Descriptor of the task.
+ * @param message Message to be delivered.
+ * @return Return true if all went well, false if the mailbox is full.
+ */
+bool uKernelPostMessage(uKernelTaskDescriptor *pTaskDescriptor, void *message)
+{
+    uint8_t next;
+    uint8_t interruptState;
+
+    if (pTaskDescriptor == NULL)
+    {
+        return false;
+    }
+
+    UKERNEL_DISABLE_INTERRUPTS(interruptState);
+    next = (pTaskDescriptor->mailboxHead + 1) & (UKERNEL_MAILBOX_SIZE - 1);
+
+    if (next == pTaskDescriptor->mailboxTail)
+    {
+        UKERNEL_ENABLE_INTERRUPTS(interruptState);
+        return false;
+    }
+
+    pTaskDescriptor->mailbox[pTaskDescriptor->mailboxHead] = message;
+    pTaskDescriptor->mailboxHead = next;
+    pTaskDescriptor->eventFlags |= UKERNEL_EVENT_MESSAGE;
+    UKERNEL_ENABLE_INTERRUPTS(interruptState);
+
+    UKERNEL_TRACE_POST(pTaskDescriptor);
+
+    return true;
+}
+
+/**
+ * Gets the events that made the running task execute. The events are cleared
+ * by the scheduler before the task is called.
+ * @return The event flags, 0 if the task was run by time.
+ */
+uint8_t uKernelGetEvents(void)
+{
+    return currentEvents;
+}
+
+/**
+ * Takes the oldest message from the mailbox of the running task. If messages
+ * are left on the mailbox the task will be run again on the next pass.
+ * @param message Pointer to store the message.
+ * @return Return true if a message was read, false if the mailbox is empty.
+ */
+bool uKernelReceiveMessage(void **message)
+{
+    uKernelTaskDescriptor *pTask = pTaskRunning;
+
+    if (pTask == NULL || pTask->mailboxTail == pTask->mailboxHead)
+    {
+        return false;
+    }
+
+    *message = pTask->mailbox[pTask->mailboxTail];
+    pTask->mailboxTail = (pTask->mailboxTail + 1) & (UKERNEL_MAILBOX_SIZE - 1);
+
+    return true;
+}
+
+#endif
+
+#if UKERNEL_USE_DEFERRED_WORK
+
+/**
+ * Queues work to be done out of the interrupt. The scheduler calls the
+ * function, in the order of the queue, before checking the tasks. Keeps the
+ * interrupt short: read what is needed to clear the interrupt source and
+ * defer the rest (e.g. the SPI or I2C transfers).
+ * @param function Function to be called.
+ * @param argument Argument of the function.
+ * @return Return true if all went well, false if the queue is full.
+ */
+bool uKernelDefer(uKernelWorkFunction function, void *argument)
+{
+    uint8_t next;
+    uint8_t interruptState;
+
+    if (function == NULL)
+    {
+        return false;
+    }
+
+    UKERNEL_DISABLE_INTERRUPTS(interruptState);
+    next = (deferredHead + 1) & (UKERNEL_DEFERRED_QUEUE_SIZE - 1);
+
+    if (next == deferredTail)
+    {
+        UKERNEL_ENABLE_INTERRUPTS(interruptState);
+        return false;
+    }
+
+    deferredQueue[deferredHead].function = function;
+    deferredQueue[deferredHead].argument = argument;
+    deferredHead = next;
+    UKERNEL_ENABLE_INTERRUPTS(interruptState);
+
+    return true;
+}
+
+/**
+ * Runs the work that was queued when the pass started. Work queued meanwhile
+ * waits for the next pass, so an interrupt storm can't starve the tasks.
+ * @return Number of work items run.
+ */
+static uint8_t uKernelRunDeferred(void)
+{
+    uint8_t head = deferredHead;
+    uint8_t executed = 0;
+    uKernelWorkItem *pItem;
+
+    while (deferredTail != head)
+    {
+        pItem = &deferredQueue[deferredTail];
+        pItem->function(pItem->argument);
+        deferredTail = (deferredTail + 1) & (UKERNEL_DEFERRED_QUEUE_SIZE - 1);
+        executed++;
+    }
+
+    return executed;
+}
+
+#endif
+
+#if UKERNEL_USE_TRACE
+
+/**
+ * Adds a record to the trace ring. It takes a few instructions, it can be
+ * called from an interrupt and by the application to mark its own events.
+ * @param type Type of the record.
+ * @param taskId Id of the task, 0 if the record is not about a task.
+ */
+void uKernelTrace(uKernelTraceType type, uint8_t taskId)
+{
+    uKernelTraceRecord *pRecord;
+    uint8_t interruptState;
+
+    if (!traceEnabled)
+    {
+        return;
+    }
+
+    UKERNEL_DISABLE_INTERRUPTS(interruptState);
+    pRecord = &traceBuffer[traceHead];
+    traceHead = (traceHead + 1) & (UKERNEL_TRACE_SIZE - 1);
+    if (traceCount < UKERNEL_TRACE_SIZE)
+    {
+        traceCount++;
+    }
+    pRecord->type = type;
+    pRecord->taskId = taskId;
+    pRecord->cycles = (uint16_t) UKERNEL_TRACE_CYCLES();
+    pRecord->tick = _counterMs;
+    UKERNEL_ENABLE_INTERRUPTS(interruptState);
+}
+
+/**
+ * Empties the trace ring and starts recording.
+ */
+void uKernelTraceClear(void)
+{
+    traceEnabled = false;
+    traceHead = 0;
+    traceCount = 0;
+    traceEnabled = true;
+}
+
+/**
+ * Sends the trace ring, oldest record first, e.g. to the USART. The recording
+ * is stopped while dumping and the ring is emptied at the end. The format,
+ * all in little endian, is a header of 10 bytes: 'u', 'K', 'T', version (1),
+ * number of records (2 bytes) and UKERNEL_TRACE_CYCLES_PER_MS (4 bytes);
+ * followed by the records of 8 bytes: type, task id, cycles (2 bytes) and
+ * tick (4 bytes). Common/KernelHost/uKernelTrace2Json.c converts it to a
+ * Chrome trace.
+ * @param putByte Function that sends one byte.
+ * @return Number of records sent.
+ */
+uint16_t uKernelTraceDump(void (*putByte)(uint8_t))
+{
+    uKernelTraceRecord *pRecord;
+    uint16_t index;
+    uint16_t count;
+    uint16_t i;
+    uint32_t cyclesPerMs = UKERNEL_TRACE_CYCLES_PER_MS;
+
+    if (putByte == NULL)
+    {
+        return 0;
+    }
+
+    traceEnabled = false;
+
+    count = traceCount;
+    index = (traceHead - count) & (UKERNEL_TRACE_SIZE - 1);
+
+    putByte('u');
+    putByte('K');
+    putByte('T');
+    putByte(1);
+    putByte((uint8_t) count);
+    putByte((uint8_t) (count >> 8));
+    putByte((uint8_t) cyclesPerMs);
+    putByte((uint8_t) (cyclesPerMs >> 8));
+    putByte((uint8_t) (cyclesPerMs >> 16));
+    putByte((uint8_t) (cyclesPerMs >> 24));
+
+    for (i = 0; i < count; i++)
+    {
+        pRecord = &traceBuffer[index];
+        index = (index + 1) & (UKERNEL_TRACE_SIZE - 1);
+
+        putByte(pRecord->type);
+        putByte(pRecord->taskId);
+        putByte((uint8_t) pRecord->cycles);
+        putByte((uint8_t) (pRecord->cycles >> 8));
+        putByte((uint8_t) pRecord->tick);
+        putByte((uint8_t) (pRecord->tick >> 8));
+        putByte((uint8_t) (pRecord->tick >> 16));
+        putByte((uint8_t) (pRecord->tick >> 24));
+    }
+
+    uKernelTraceClear();
+
+    return count;
+}
+
+#endif
+
+/**
+ * Checks if a task is waiting inside uKernelSleep.
+ * @param pTask Descriptor of the task.
+ * @return True if the task is sleeping.
+ */
+static bool uKernelIsSleeping(uKernelTaskDescriptor *pTask)
+{
+    uint8_t index;
+
+    for (index = 0; index < sleepDepth; index++)
+    {
+        if (sleepingTasks[index] == pTask)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+#if UKERNEL_USE_WATCHDOG
+
+/**
+ * Makes a task critical, it has to check in at least every timeout or the
+ * hardware watchdog is no longer kicked. Each return of the task body is a
+ * check-in, so the timeout has to be longer than the period (or the time
+ * between posts of a UKERNEL_WAITEVENT task) plus the longest run.
+ * @param pTaskDescriptor Descriptor of the task.
+ * @param timeout Maximum time between check-ins in milliseconds, 0 to make the
+ *                task not critical again.
+ * @return True if all went well, false otherwise.
+ */
+bool uKernelSetTaskWatchdog(uKernelTaskDescriptor *pTaskDescriptor,
+                            uint32_t timeout)
+{
+    if (!_initialized || pTaskDescriptor == NULL)
+    {
+        return false;
+    }
+
+    pTaskDescriptor->lastCheckIn = _counterMs;
+    pTaskDescriptor->watchdogTimeout = timeout;
+
+    return true;
+}
+
+/**
+ * Checks in the running task, for tasks that legitimately run for longer than
+ * their timeout (e.g. a loop writing a flash page).
+ */
+void uKernelWatchdogCheckIn(void)
+{
+    if (pTaskRunning != NULL)
+    {
+        UKERNEL_CHECK_IN(pTaskRunning);
+    }
+}
+
+/**
+ * Id of the task that stopped the watchdog kicks.
+ * @return The id given by uKernelAddTask, 0 while all the critical tasks are
+ *         healthy.
+ */
+uint8_t uKernelGetWatchdogOffender(void)
+{
+    return watchdogOffender;
+}
+
+/**
+ * Checks if a critical task missed its check-in.
+ * @param pTask Descriptor of the task.
+ * @param now _counterMs.
+ * @return True if the task is late.
+ */
+static bool uKernelWatchdogLate(uKernelTaskDescriptor *pTask, uint32_t now)
+{
+    return (pTask->watchdogTimeout != 0)
+            && (pTask->taskStatus != UKERNEL_PAUSED)
+            && (now - pTask->lastCheckIn) > pTask->watchdogTimeout;
+}
+
+/**
+ * Stops the kicks and reports the late task, only the first one is reported.
+ * @param pTask Descriptor of the task.
+ */
+static void uKernelWatchdogTrip(uKernelTaskDescriptor *pTask)
+{
+    if (watchdogOffender == 0)
+    {
+        watchdogOffender = pTask->taskId;
+        UKERNEL_WATCHDOG_OFFENDER(pTask->taskId);
+    }
+}
+
+/**
+ * Once per tick, kicks the hardware watchdog if every critical task checked in
+ * on time. Tasks waiting in uKernelSleep still give the CPU back, they count as
+ * checked in.
+ */
+static void uKernelWatchdogService(void)
+{
+    uKernelTaskDescriptor *pTask = pTaskFirst;
+    uint32_t now = _counterMs;
+    uint8_t count;
+
+    if ((watchdogOffender != 0) || (now == watchdogChecked))
+    {
+        return;
+    }
+
+    watchdogChecked = now;
+
+    for (count = numberTasks; count != 0; count--)
+    {
+        if (uKernelIsSleeping(pTask))
+        {
+            UKERNEL_CHECK_IN(pTask);
+        }
+        else if (uKernelWatchdogLate(pTask, now))
+        {
+            uKernelWatchdogTrip(pTask);
+            return;
+        }
+
+        pTask = pTask->pTaskNext;
+    }
+
+    UKERNEL_WATCHDOG_KICK();
+}
+
+#define UKERNEL_WATCHDOG_SERVICE()  uKernelWatchdogService()
+#else
+#define UKERNEL_WATCHDOG_SERVICE()
+#endif
+
+/**
+ * Executes a task if it is time or if something was posted to it.
+ * @param pTask Descriptor of the task.
+ * @return 1 if the task was executed, 0 otherwise.
+ */
+static uint8_t uKernelRunTask(uKernelTaskDescriptor *pTask)
+{
+    uint32_t now;
+#if UKERNEL_USE_STATISTICS
+    uint32_t deadline;
+#endif
+#if UKERNEL_USE_EVENTS
+    uint8_t interruptState;
+#endif
+
+    //the task is not running
+    if ((pTask->taskStatus == UKERNEL_PAUSED) || uKernelIsSleeping(pTask))
+    {
+        return 0;
+    }
+
+    pTaskRunning = pTask;
+
+#if UKERNEL_USE_EVENTS
+    //something was posted, run it now without touching the period
+    if (pTask->eventFlags != 0)
+    {
+        UKERNEL_DISABLE_INTERRUPTS(interruptState);
+        currentEvents = pTask->eventFlags;
+        pTask->eventFlags = 0;
+        UKERNEL_ENABLE_INTERRUPTS(interruptState);
+
+        if (pTask->taskStatus & UKERNEL_ONETIME)
+        {
+            pTask->taskStatus = UKERNEL_PAUSED; //pause the task
+        }
+
+        UKERNEL_TRACE_TASK_START(pTask);
+        pTask->taskPointer(); //call the task
+        UKERNEL_TRACE_TASK_END(pTask);
+        UKERNEL_CHECK_IN(pTask);
+#if UKERNEL_USE_STATISTICS
+        pTask->releases++;
+#endif
+
+        //messages not read by the task keep it running
+        if (pTask->mailboxTail != pTask->mailboxHead)
+        {
+            uKernelPostEvent(pTask, UKERNEL_EVENT_MESSAGE);
+        }
+
+        currentEvents = 0;
+        pTaskRunning = NULL;
+
+        return 1;
+    }
+#endif
+
+    now = uKernelTaskTime(pTask);
+
+    //this trick overrun the overflow of _counterMs
+    if ((pTask->taskStatus & UKERNEL_WAITEVENT)
+            || (int32_t) (now - pTask->plannedTask) < 0)
+    {
+        pTaskRunning = NULL;
+
+        return 0;
+    }
+
+#if UKERNEL_USE_STATISTICS
+    //the run has to finish before the next release
+    deadline = pTask->plannedTask + pTask->userTasksInterval;
+#endif
+
+#if UKERNEL_USE_COROUTINES && UKERNEL_USE_GRID
+    //the coroutine continues after a wait, not a new release
+    if (pTask->coroutineWaiting)
+    {
+        pTask->plannedTask = pTask->coroutineRelease;
+        pTask->coroutineWaiting = false;
+    }
+    else
+#endif
+    if (pTask->taskStatus & UKERNEL_ONETIME)
+    {
+        pTask->taskStatus = UKERNEL_PAUSED; //pause the task
+    }
+    else
+    {
+        if (UKERNEL_ON_GRID(pTask))
+        {
+            //next release on the grid of the period, so the task does not drift
+            pTask->plannedTask += pTask->userTasksInterval;
+
+            //releases already past their deadline are lost and skipped
+            if ((int32_t) (now - pTask->plannedTask) >=
+                    (int32_t) pTask->userTasksInterval)
+            {
+                uint32_t lost = (now - pTask->plannedTask)
+                        / pTask->userTasksInterval;
+
+                pTask->plannedTask += lost * pTask->userTasksInterval;
+#if UKERNEL_USE_STATISTICS
+                pTask->releases += lost;
+                pTask->deadlineMisses += lost;
+#endif
+            }
+        }
+        else
+        {
+            //let's schedule next start
+            pTask->plannedTask = now + pTask->userTasksInterval;
+        }
+    }
+
+    UKERNEL_TRACE_TASK_START(pTask);
+    pTask->taskPointer(); //call the task
+    UKERNEL_TRACE_TASK_END(pTask);
+    UKERNEL_CHECK_IN(pTask);
+
+#if UKERNEL_USE_STATISTICS
+    pTask->releases++;
+
+    if ((int32_t) (uKernelTaskTime(pTask) - deadline) > 0)
+    {
+        pTask->deadlineMisses++;
+    }
+#endif
+
+    pTaskRunning = NULL;
+
+    return 1;
+}
+
+#if UKERNEL_SCHEDULING_POLICY != UKERNEL_POLICY_ROUND_ROBIN
+
+/**
+ * Checks if a task has to run.
+ * @param pTask Descriptor of the task.
+ * @return True if the task is ready.
+ */
+static bool uKernelIsReady(uKernelTaskDescriptor *pTask)
+{
+    if ((pTask->taskStatus == UKERNEL_PAUSED) || uKernelIsSleeping(pTask))
+    {
+        return false;
+    }
+
+#if UKERNEL_USE_EVENTS
+    if (pTask->eventFlags != 0)
+    {
+        return true;
+    }
+#endif
+
+    return !(pTask->taskStatus & UKERNEL_WAITEVENT)
+            && (int32_t) (uKernelTaskTime(pTask) - pTask->plannedTask) >= 0;
+}
+
+/**
+ * Priority key of a ready task, the lowest key runs first.
+ * @param pTask Descriptor of the task.
+ * @return The time to the deadline in microseconds (signed) for EDF, the
+ *         period in microseconds for rate monotonic or the priority.
+ */
+static uint32_t uKernelPriorityKey(uKernelTaskDescriptor *pTask)
+{
+#if UKERNEL_SCHEDULING_POLICY == UKERNEL_POLICY_EDF
+    int32_t remaining;
+
+#if UKERNEL_USE_MICROSECONDS
+    if (pTask->microseconds)
+    {
+        remaining = (int32_t) (pTask->plannedTask + pTask->userTasksInterval
+                - (uint32_t) uKernelGetTimeUs());
+
+        if (remaining > UKERNEL_EDF_HORIZON_MS * 1000L)
+        {
+            remaining = UKERNEL_EDF_HORIZON_MS * 1000L;
+        }
+        else if (remaining < -UKERNEL_EDF_HORIZON_MS * 1000L)
+        {
+            remaining = -UKERNEL_EDF_HORIZON_MS * 1000L;
+        }
+
+        return (uint32_t) remaining;
+    }
+#endif
+#if UKERNEL_USE_EVENTS
+    //a posted task is released now
+    if (pTask->eventFlags != 0)
+    {
+        remaining = (int32_t) pTask->userTasksInterval;
+    }
+    else
+#endif
+    {
+        remaining = (int32_t) (pTask->plannedTask + pTask->userTasksInterval
+                - _counterMs);
+    }
+
+    if (remaining > UKERNEL_EDF_HORIZON_MS)
+    {
+        remaining = UKERNEL_EDF_HORIZON_MS;
+    }
+    else if (remaining < -UKERNEL_EDF_HORIZON_MS)
+    {
+        remaining = -UKERNEL_EDF_HORIZON_MS;
+    }
+
+#if UKERNEL_USE_MICROSECONDS
+    //the deadline is on a tick, count from now as the microseconds tasks
+    return (uint32_t) (remaining * 1000L)
+            - ((uint32_t) uKernelGetTimeUs() - _counterMs * 1000UL);
+#else
+    return (uint32_t) (remaining * 1000L);
+#endif
+#elif UKERNEL_SCHEDULING_POLICY == UKERNEL_POLICY_FIXED_PRIORITY
+    return pTask->priority;
+#else
+    return uKernelPeriodUs(pTask, pTask->userTasksInterval);
+#endif
+}
+
+/**
+ * Runs the deferred work and then the ready task with the highest priority of
+ * the policy. Between tasks with the same priority the order of the list is
+ * used, round robin.
+ * @return Number of tasks and work items executed, 0 means that the scheduler
+ *         is idle.
+ */
+uint8_t uKernelSchedulerPass(void)
+{
+    uKernelTaskDescriptor *pTask = pTaskSchedule;
+    uKernelTaskDescriptor *pBest = NULL;
+    uint32_t bestKey = 0;
+    uint32_t key;
+    uint8_t count;
+    uint8_t executed = 0;
+
+#if UKERNEL_USE_DEFERRED_WORK
+    executed = uKernelRunDeferred();
+#endif
+#if UKERNEL_USE_STATIC_TASKS
+    //no descriptor while the static tasks run, even in a nested pass
+    pTaskRunning = NULL;
+    executed += uKernelStaticPass();
+#endif
+    UKERNEL_WATCHDOG_SERVICE();
+
+    for (count = numberTasks; count != 0 && pTask != NULL; count--)
+    {
+        if (uKernelIsReady(pTask))
+        {
+            key = uKernelPriorityKey(pTask);
+
+#if UKERNEL_SCHEDULING_POLICY == UKERNEL_POLICY_EDF
+            //the times to the deadlines are signed, a late task is below 0
+            if ((pBest == NULL) || (int32_t) key < (int32_t) bestKey)
+#else
+            if ((pBest == NULL) || key < bestKey)
+#endif
+            {
+                pBest = pTask;
+                bestKey = key;
+            }
+        }
+
+        pTask = pTask->pTaskNext;
+    }
+
+    if (pBest == NULL)
+    {
+        UKERNEL_TRACE_IDLE(executed);
+        return executed;
+    }
+
+    //the search starts after this task on the next pass
+    pTaskSchedule = pBest->pTaskNext;
+
+    uKernelRunTask(pBest);
+
+    return executed + 1;
+}
+
+#else
+
+/**
+ * Runs one rotation of the scheduler, the deferred work is run first and then
+ * each task of the list is checked once and executed if it is time or if
+ * something was posted to it.
+ * @return Number of tasks and work items executed, 0 means that the scheduler is idle.
+ */
+uint8_t uKernelSchedulerPass(void)
+{
+    uint8_t count;
+    uint8_t executed = 0;
+
+#if UKERNEL_USE_DEFERRED_WORK
+    executed = uKernelRunDeferred();
+#endif
+#if UKERNEL_USE_STATIC_TASKS
+    //no descriptor while the static tasks run, even in a nested pass
+    pTaskRunning = NULL;
+    executed += uKernelStaticPass();
+#endif
+    UKERNEL_WATCHDOG_SERVICE();
+
+    for (count = numberTasks; count != 0 && pTaskSchedule != NULL; count--)
+    {
+        executed += uKernelRunTask(pTaskSchedule);
+
+        // If a task has removed all the tasks and no task was added, the
+        // pointer is null
+        if (pTaskSchedule != NULL)
+        {
+            // Set the scheduler pointer on the next task
+            pTaskSchedule = pTaskSchedule->pTaskNext;
+        }
+    }
+
+    UKERNEL_TRACE_IDLE(executed);
+
+    return executed;
+}
+
+#endif
+
+/**
+ * Scheduling. This runs the kernel itself.
+ */
+void uKernelScheduler(void)
+{
+    while (1)
+    {
+        if (uKernelSchedulerPass() == 0)
+        {
+#if UKERNEL_USE_TICKLESS
+            UKERNEL_IDLE(uKernelGetNextWakeup());
+#else
+            UKERNEL_IDLE(1);
+#endif
+        }
+    }
+}
+
+/**
+ * This funtion has to be called from the timer interrupt routine, every
+ * millisecond.
+ */
+void uKernelTimerInterruptHandler(void)
+{
+    if (++_counterMs == 0)
+    {
+        counterMsHigh++;
+    }
+
+#if UKERNEL_USE_WATCHDOG
+    //a task stuck in its body never returns to the scheduler, critical or not
+    //the kicks stop with it, so it is the one reported
+    if ((pTaskRunning != NULL) && (watchdogOffender == 0)
+            && (uKernelWatchdogLate(pTaskRunning, _counterMs)
+                || (_counterMs - watchdogChecked) > UKERNEL_WATCHDOG_WINDOW))
+    {
+        uKernelWatchdogTrip(pTaskRunning);
+    }
+#endif
+}
+
+/**
+ * Milliseconds since uKernelInit, on 64 bits so they never overflow. It reads
+ * the counters again if the tick changed them meanwhile, no need to disable
+ * the interrupts (even on 8 bit micros where reading 32 bits takes several
+ * instructions).
+ * @return The time in milliseconds.
+ */
+uint64_t uKernelGetTimeMs(void)
+{
+    uint32_t high;
+    uint32_t low;
+
+    do
+    {
+        high = counterMsHigh;
+        low = _counterMs;
+    }
+    while ((high != counterMsHigh) || (low != _counterMs));
+
+    return ((uint64_t) high << 32) | low;
+}
+
+/**
+ * Microseconds since uKernelInit, the tick plus the count of its timer. Same
+ * lock free reading as uKernelGetTimeMs.
+ * @return The time in microseconds.
+ */
+uint64_t uKernelGetTimeUs(void)
+{
+    uint32_t high;
+    uint32_t low;
+    uint32_t count;
+    bool pending;
+    uint64_t milliseconds;
+
+    do
+    {
+        high = counterMsHigh;
+        low = _counterMs;
+        count = UKERNEL_TIMER_COUNT();
+        pending = UKERNEL_TIMER_PENDING();
+    }
+    while ((high != counterMsHigh) || (low != _counterMs));
+
+    milliseconds = ((uint64_t) high << 32) | low;
+
+    //the timer rolled over and the tick was not counted yet, a count close to
+    //the end means that the roll over came after reading it
+    if (pending && (count * 2 < UKERNEL_TIMER_COUNTS_PER_MS))
+    {
+        milliseconds++;
+    }
+
+    return milliseconds * 1000
+            + (uint64_t) count * 1000 / UKERNEL_TIMER_COUNTS_PER_MS;
+}
+
+/**
+ * Time base of a task.
+ * @param pTask Descriptor of the task.
+ * @return _counterMs or the low 32 bits of the microseconds.
+ */
+static uint32_t uKernelTaskTime(uKernelTaskDescriptor *pTask)
+{
+#if UKERNEL_USE_MICROSECONDS
+    if (pTask->microseconds)
+    {
+        return (uint32_t) uKernelGetTimeUs();
+    }
+#else
+    (void) pTask;
+#endif
+
+    return _counterMs;
+}
+
+#if UKERNEL_USE_TICKLESS
+
+/**
+ * Time until the scheduler has work to do.
+ * @return Milliseconds until the next task is due, 0 if there is work to do
+ *         now and UINT32_MAX if no task waits for time. With the watchdog it
+ *         is never longer than UKERNEL_WATCHDOG_WINDOW, so the idle doesn't
+ *         outlast the kicks.
+ */
+uint32_t uKernelGetNextWakeup(void)
+{
+    uKernelTaskDescriptor *pTask = pTaskFirst;
+#if UKERNEL_USE_STATIC_TASKS
+    uint32_t wakeup = uKernelStaticGetNextWakeup();
+#else
+    uint32_t wakeup = UINT32_MAX;
+#endif
+    int32_t remaining;
+    uint8_t count;
+
+#if UKERNEL_USE_DEFERRED_WORK
+    if (deferredHead != deferredTail)
+    {
+        return 0;
+    }
+#endif
+
+    for (count = numberTasks; count != 0 && pTask != NULL; count--)
+    {
+        if (pTask->taskStatus != UKERNEL_PAUSED)
+        {
+#if UKERNEL_USE_EVENTS
+            if (pTask->eventFlags != 0)
+            {
+                return 0;
+            }
+#endif
+            if (!(pTask->taskStatus & UKERNEL_WAITEVENT))
+            {
+                remaining = (int32_t) (pTask->plannedTask
+                        - uKernelTaskTime(pTask));
+
+                if (remaining <= 0)
+                {
+                    return 0;
+                }
+#if UKERNEL_USE_MICROSECONDS
+                if (pTask->microseconds)
+                {
+                    remaining = remaining / 1000;
+                }
+#endif
+
+                if ((uint32_t) remaining < wakeup)
+                {
+                    wakeup = remaining;
+                }
+            }
+        }
+
+        pTask = pTask->pTaskNext;
+    }
+
+#if UKERNEL_USE_WATCHDOG
+    //the next pass after the wakeup kicks the watchdog
+    if (wakeup > UKERNEL_WATCHDOG_WINDOW)
+    {
+        wakeup = UKERNEL_WATCHDOG_WINDOW;
+    }
+#endif
+
+    return wakeup;
+}
+
+/**
+ * Catches up the time after a tickless sleep, e.g. with the value of a low
+ * power timer that ran while the tick was stopped.
+ * @param milliseconds Time slept.
+ */
+void uKernelAdvanceTime(uint32_t milliseconds)
+{
+    uint8_t interruptState;
+
+    UKERNEL_DISABLE_INTERRUPTS(interruptState);
+    _counterMs += milliseconds;
+    if (_counterMs < milliseconds)
+    {
+        counterMsHigh++;
+    }
+    UKERNEL_ENABLE_INTERRUPTS(interruptState);
+}
+
+#endif
+
+/**
+ * Waits some time and lets the other tasks run meanwhile. The scheduler keeps
+ * running from inside this function, without the task that called it, and it
+ * returns to the task when the time is over. It can be called from a task or
+ * before the scheduler starts (e.g. by the drivers init). The task must not
+ * count on its global variables staying the same while it sleeps, the other
+ * tasks may change them.
+ * @param milliseconds Time to wait.
+ */
+void uKernelSleep(uint32_t milliseconds)
+{
+    uint32_t end = _counterMs + milliseconds;
+    uKernelTaskDescriptor *pTaskSleeping = pTaskRunning;
+#if UKERNEL_USE_EVENTS
+    uint8_t events = currentEvents;
+#endif
+#if UKERNEL_USE_TICKLESS
+    uint32_t wakeup;
+#endif
+
+    //too deep, the kernel is not ready or a static task (no descriptor to
+    //keep it out of the nested passes), only wait
+    if ((_initialized == false) || (sleepDepth == UKERNEL_SLEEP_NESTING)
+#if UKERNEL_USE_STATIC_TASKS
+            || uKernelStaticIsRunning()
+#endif
+            )
+    {
+        //this trick overrun the overflow of _counterMs
+        while ((int32_t) (_counterMs - end) < 0)
+        {
+            UKERNEL_IDLE(1);
+        }
+
+        return;
+    }
+
+    sleepingTasks[sleepDepth++] = pTaskSleeping;
+
+    while ((int32_t) (_counterMs - end) < 0)
+    {
+        if (uKernelSchedulerPass() == 0)
+        {
+#if UKERNEL_USE_TICKLESS
+            wakeup = uKernelGetNextWakeup();
+            if (wakeup > end - _counterMs)
+            {
+                wakeup = end - _counterMs;
+            }
+            UKERNEL_IDLE(wakeup);
+#else
+            UKERNEL_IDLE(1);
+#endif
+        }
+    }
+
+    sleepDepth--;
+
+    //the nested passes changed the running task
+    pTaskRunning = pTaskSleeping;
+#if UKERNEL_USE_EVENTS
+    currentEvents = events;
+#endif
+}
+
+/**
+ * Delay in miliseconds, the other tasks keep running, see uKernelSleep.
+ */
+void uKernelDelayMiliseconds(unsigned int delay)
+{
+    uKernelSleep(delay);
+}
+
+unsigned char uKernelSetTask(uKernelTaskDescriptor *pTaskDescriptor,
+                             uint32_t taskInterval,
+                             uKernelTaskStatus tStatus)
+{
+    if ((_initialized == false) || (numberTasks == MAX_TASKS_NUMBER)
+            || (pTaskDescriptor == NULL))
+    {
+        return false;
+    }
+
+#if UKERNEL_USE_COROUTINES && UKERNEL_USE_GRID
+    //the wait of the coroutine is dropped, back to its release on the grid
+    if (pTaskDescriptor->coroutineWaiting)
+    {
+        pTaskDescriptor->plannedTask = pTaskDescriptor->coroutineRelease;
+        pTaskDescriptor->coroutineWaiting = false;
+    }
+#endif
+
+    pTaskDescriptor->taskStatus = tStatus;
+
+    if (tStatus == UKERNEL_SCHEDULED)
+    {
+        if (taskInterval == 0)
+        {
+#if UKERNEL_USE_GROUPS
+            if (pTaskDescriptor->aligned)
+            {
+                uint32_t lag = _counterMs - pTaskDescriptor->plannedTask;
+
+                //back on the next release of its group
+                if (((int32_t) lag > 0)
+                        && (pTaskDescriptor->userTasksInterval != 0))
+                {
+                    pTaskDescriptor->plannedTask +=
+                            (lag + pTaskDescriptor->userTasksInterval - 1)
+                            / pTaskDescriptor->userTasksInterval
+                            * pTaskDescriptor->userTasksInterval;
+                }
+            }
+            else
+#endif
+            {
+                pTaskDescriptor->plannedTask = uKernelTaskTime(pTaskDescriptor)
+                        + pTaskDescriptor->userTasksInterval;
+            }
         }
         else
         {
             pTaskDescriptor->plannedTask =
-                    _counterMs + taskInterval;
+                    uKernelTaskTime(pTaskDescriptor) + taskInterval;
         }
     }
     
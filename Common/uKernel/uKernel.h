@@ -13,6 +13,10 @@
  *  limitations of micrcontrollers. The maximum number of task is 255 but I am
  *  sure that the memory will go out first. If anyone needs more tasks let me
  *  know.
+ *  This is the scheduler core of the library, pKernel and Tasker are only
+ *  their old API on top of it, so all of them share the same _counterMs and
+ *  dispatch loop. Everything else is chosen at compile time with the macros
+ *  below (storage, scheduling policy, statistics, tickless idle...).
  */
 
 #ifndef UKERNEL_H
@@ -32,6 +36,251 @@ extern "C"
 /**Set your max interval here (max 2^32-1) - default 3600000 (1 hour)*/
 #define MAX_TASK_INTERVAL           3600000UL
 
+/**Enables the per task event flags and mailbox (RAM on every descriptor).*/
+#ifndef UKERNEL_USE_EVENTS
+#define UKERNEL_USE_EVENTS          0
+#endif
+
+/**Number of messages each task mailbox can hold, must be a power of 2.*/
+#ifndef UKERNEL_MAILBOX_SIZE
+#define UKERNEL_MAILBOX_SIZE        4
+#endif
+
+/**
+ * Critical section used when the task and an interrupt share data. By default
+ * it does nothing, which is enough if only one interrupt level posts to a task.
+ * If interrupts of different priorities post to the same task define these to
+ * save the state of the interrupts in the local variable state (uint8_t) and
+ * disable them, and then restore the saved state. They are also called from
+ * the interrupts, so never enable the interrupts unconditionally, e.g. on the
+ * PIC18:
+ * @code
+ * #define UKERNEL_DISABLE_INTERRUPTS(state) \
+ *     ((state) = INTCONbits.GIEH, INTCONbits.GIEH = 0)
+ * #define UKERNEL_ENABLE_INTERRUPTS(state)  (INTCONbits.GIEH = (state))
+ * @endcode
+ */
+#ifndef UKERNEL_DISABLE_INTERRUPTS
+#define UKERNEL_DISABLE_INTERRUPTS(state)   ((state) = 0)
+#endif
+#ifndef UKERNEL_ENABLE_INTERRUPTS
+#define UKERNEL_ENABLE_INTERRUPTS(state)    ((void) (state))
+#endif
+
+/**Enables the continuation state used by the uKernelCoroutine.h macros.*/
+#ifndef UKERNEL_USE_COROUTINES
+#define UKERNEL_USE_COROUTINES      0
+#endif
+
+/**Tasks are run in the order of the list, the default.*/
+#define UKERNEL_POLICY_ROUND_ROBIN  0
+/**The ready task with the earliest deadline (end of its period) runs first.*/
+#define UKERNEL_POLICY_EDF          1
+/**The ready task with the shortest period runs first.*/
+#define UKERNEL_POLICY_RATE_MONOTONIC 2
+/**The ready task with the highest priority (lowest number) runs first.*/
+#define UKERNEL_POLICY_FIXED_PRIORITY 3
+
+/**
+ * Scheduling policy. With EDF or rate monotonic the tasks are released on a
+ * fixed grid (no drift) and the deadline of each run is the next release. Tasks
+ * added with a worst case execution time go through an admission check, EDF
+ * accepts up to 100% of utilization and rate monotonic up to the Liu & Layland
+ * bound n(2^(1/n) - 1). With fixed priorities, set by uKernelSetTaskPriority(),
+ * only 100% of utilization is checked. The tasks are not preempted, so a long task can still
+ * make a short one miss, keep the execution times small.
+ */
+#ifndef UKERNEL_SCHEDULING_POLICY
+#define UKERNEL_SCHEDULING_POLICY   UKERNEL_POLICY_ROUND_ROBIN
+#endif
+
+/**Keeps the number of runs and deadline misses of each task.*/
+#ifndef UKERNEL_USE_STATISTICS
+#define UKERNEL_USE_STATISTICS      (UKERNEL_SCHEDULING_POLICY != UKERNEL_POLICY_ROUND_ROBIN)
+#endif
+
+/**Enables the queue of work deferred by the interrupts, see uKernelDefer.*/
+#ifndef UKERNEL_USE_DEFERRED_WORK
+#define UKERNEL_USE_DEFERRED_WORK   0
+#endif
+
+/**Number of work items the queue can hold, must be a power of 2.*/
+#ifndef UKERNEL_DEFERRED_QUEUE_SIZE
+#define UKERNEL_DEFERRED_QUEUE_SIZE 8
+#endif
+
+/**
+ * Number of descriptors kept by the kernel for uKernelCreateTask, 0 if all the
+ * descriptors are given by the application (the default).
+ */
+#ifndef UKERNEL_POOL_SIZE
+#define UKERNEL_POOL_SIZE           0
+#endif
+
+/**
+ * Tickless idle. When a pass of uKernelScheduler runs nothing,
+ * UKERNEL_IDLE(ms) is called with the milliseconds until the next task is due
+ * (UINT32_MAX if no task waits for time). The application can stop the tick
+ * and sleep that long, and then catch up the time with uKernelAdvanceTime.
+ */
+#ifndef UKERNEL_USE_TICKLESS
+#define UKERNEL_USE_TICKLESS        0
+#endif
+
+/**On the host port the idle moves the virtual clock, see KernelHost.h.*/
+#if (defined(UKERNEL_HOST) || defined(PKERNEL_HOST) || defined(TASKER_HOST)) \
+    && !defined(UKERNEL_IDLE)
+void KernelHostIdle(uint32_t milliseconds);
+#define UKERNEL_IDLE(ms)            KernelHostIdle(ms)
+#endif
+#if (defined(UKERNEL_HOST) || defined(PKERNEL_HOST) || defined(TASKER_HOST)) \
+    && !defined(UKERNEL_TIMER_COUNT)
+uint32_t KernelHostGetTimerCount(void);
+#define UKERNEL_TIMER_COUNT()       KernelHostGetTimerCount()
+#define UKERNEL_TIMER_COUNTS_PER_MS 1000
+#endif
+
+/**Idle hook of the scheduler, e.g. SLEEP() on the PIC18 or __WFI() on ARM.*/
+#ifndef UKERNEL_IDLE
+#define UKERNEL_IDLE(ms)
+#endif
+
+/**
+ * Number of uKernelSleep calls that can be nested (a task sleeps, another task
+ * runs and sleeps too...). Past it uKernelSleep waits without running tasks.
+ */
+#ifndef UKERNEL_SLEEP_NESTING
+#define UKERNEL_SLEEP_NESTING       2
+#endif
+
+/**
+ * Count of the hardware timer that generates the tick, counting up from 0 to
+ * UKERNEL_TIMER_COUNTS_PER_MS - 1 between two ticks. It gives the microseconds
+ * of uKernelGetTimeUs(), e.g. (SysTick->LOAD - SysTick->VAL) on the STM32 or
+ * (TMR0 - 0xE0BE) on the PIC18 with the timer 0 reloaded for 1 ms.
+ */
+#ifndef UKERNEL_TIMER_COUNT
+#define UKERNEL_TIMER_COUNT()       0
+#endif
+
+/**Counts of UKERNEL_TIMER_COUNT() in one millisecond.*/
+#ifndef UKERNEL_TIMER_COUNTS_PER_MS
+#define UKERNEL_TIMER_COUNTS_PER_MS 1
+#endif
+
+/**
+ * True if the timer rolled over but its interrupt was not served yet (e.g.
+ * read from another interrupt), (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) on the
+ * STM32 or INTCONbits.TMR0IF on the PIC18.
+ */
+#ifndef UKERNEL_TIMER_PENDING
+#define UKERNEL_TIMER_PENDING()     0
+#endif
+
+/**
+ * Enables the tasks with a period in microseconds, uKernelAddTaskMicroseconds.
+ * They need UKERNEL_TIMER_COUNT() and are checked on every pass.
+ */
+#ifndef UKERNEL_USE_MICROSECONDS
+#define UKERNEL_USE_MICROSECONDS    0
+#endif
+
+/**
+ * Task groups. A task added with uKernelAddGroupTask() (or aligned later with
+ * uKernelAlignTask()) is released on the absolute grid k * period + phase of
+ * the time base. All the tasks with the same period and phase become due on
+ * the same tick and run back to back in one wakeup, instead of each one waking
+ * the CPU at the time it was added. Different phases spread the load of a bus
+ * on purpose, e.g. five sensors polled every 100 ms with phases 0, 20, 40...
+ */
+#ifndef UKERNEL_USE_GROUPS
+#define UKERNEL_USE_GROUPS          0
+#endif
+
+/**
+ * Static task table. Tasks whose function and period never change can be
+ * declared at compile time in UKERNEL_STATIC_TASKS_FILE, their function and
+ * period stay on a const table and only 5 bytes per task take RAM. Build
+ * uKernelStatic.c too, see uKernelStatic.h.
+ */
+#ifndef UKERNEL_USE_STATIC_TASKS
+#define UKERNEL_USE_STATIC_TASKS    0
+#endif
+
+/**Records what the scheduler does on a ring buffer, see uKernelTraceDump.*/
+#ifndef UKERNEL_USE_TRACE
+#define UKERNEL_USE_TRACE           0
+#endif
+
+/**Number of records of the trace ring, must be a power of 2 (8 bytes each).*/
+#ifndef UKERNEL_TRACE_SIZE
+#define UKERNEL_TRACE_SIZE          64
+#endif
+
+/**
+ * Sub millisecond time stamp of the trace records, the count of the timer that
+ * generates the tick (e.g. TMR0 on the PIC18). Only the low 16 bits are kept,
+ * so the count of one millisecond has to fit in them: on a STM32F1 at 72 MHz
+ * SysTick on HCLK counts 72000 per ms and wraps, clocked from HCLK/8 it counts
+ * 9000:
+ * @code
+ * SysTick_Config(SystemCoreClock / 8000);
+ * SysTick_CLKSourceConfig(SysTick_CLKSource_HCLK_Div8);
+ *
+ * #define UKERNEL_TRACE_CYCLES()      (SysTick->LOAD - SysTick->VAL)
+ * #define UKERNEL_TRACE_CYCLES_PER_MS 9000
+ * @endcode
+ */
+#ifndef UKERNEL_TRACE_CYCLES
+#define UKERNEL_TRACE_CYCLES()      0
+#endif
+
+/**Counts of UKERNEL_TRACE_CYCLES() in one millisecond, 0 if not used.*/
+#ifndef UKERNEL_TRACE_CYCLES_PER_MS
+#define UKERNEL_TRACE_CYCLES_PER_MS 0
+#endif
+
+/**
+ * Task health monitoring. Tasks given a check-in timeout with
+ * uKernelSetTaskWatchdog() are critical, each time their body returns (or they
+ * call uKernelWatchdogCheckIn()) they check in. Once per tick the scheduler
+ * calls UKERNEL_WATCHDOG_KICK() only if every critical task checked in on
+ * time, otherwise it stops kicking and calls UKERNEL_WATCHDOG_OFFENDER(id)
+ * once with the id of the late task, so it can be kept on a backup register
+ * before the hardware watchdog resets the micro (see STM32F1/Watchdog.h). A
+ * task stuck in its body is caught by the tick.
+ */
+#ifndef UKERNEL_USE_WATCHDOG
+#define UKERNEL_USE_WATCHDOG        0
+#endif
+
+/**Reloads the hardware watchdog, e.g. WatchdogKick() or ClrWdt().*/
+#ifndef UKERNEL_WATCHDOG_KICK
+#define UKERNEL_WATCHDOG_KICK()
+#endif
+
+/**Called once with the id of the first task that missed its check-in.*/
+#ifndef UKERNEL_WATCHDOG_OFFENDER
+#define UKERNEL_WATCHDOG_OFFENDER(taskId)
+#endif
+
+/**
+ * Longest time in ms without kicks, shorter than the timeout of the hardware
+ * watchdog. The tickless idle is cut to it, and a task (critical or not) that
+ * runs for longer without returning is reported as the offender by the tick.
+ */
+#ifndef UKERNEL_WATCHDOG_WINDOW
+#define UKERNEL_WATCHDOG_WINDOW     100
+#endif
+
+/**Some tasks keep their releases on the grid of their period.*/
+#define UKERNEL_USE_GRID            ((UKERNEL_SCHEDULING_POLICY              \
+        != UKERNEL_POLICY_ROUND_ROBIN) || UKERNEL_USE_MICROSECONDS          \
+        || UKERNEL_USE_GROUPS)
+
+/**Event flag set by the kernel when there are messages on the mailbox.*/
+#define UKERNEL_EVENT_MESSAGE       0x80
+
 typedef enum
 {
     /**For a task that doesn't have to start immediately.*/
@@ -44,17 +293,57 @@ typedef enum
     UKERNEL_IMMEDIATESTART = 0x05, //0b00000101
     /**For the task to be executed one time as soon as it is added.*/
     UKERNEL_ONETIME_IMMEDIATESTART = 0x07, //0b00000111
+    /**For a task that only runs when an event or a message is posted to it.*/
+    UKERNEL_WAITEVENT = 0x08, //0b00001000
     /**Error, task not found.*/
     UKERNEL_ERROR = 0xFF //0b11111111
 } uKernelTaskStatus;
 
+/**Types of the trace records.*/
+typedef enum
+{
+    /**The scheduler calls a task.*/
+    UKERNEL_TRACE_TASK_START = 0x01,
+    /**The task returned to the scheduler.*/
+    UKERNEL_TRACE_TASK_END = 0x02,
+    /**An event or a message was posted to a task (usually from an ISR).*/
+    UKERNEL_TRACE_POST = 0x03,
+    /**A pass of the scheduler ran no task.*/
+    UKERNEL_TRACE_IDLE_ENTER = 0x04,
+    /**The scheduler found work after being idle.*/
+    UKERNEL_TRACE_IDLE_EXIT = 0x05
+} uKernelTraceType;
+
+/**Record of the trace ring.*/
+typedef struct
+{
+    /**uKernelTraceType of the record*/
+    uint8_t type;
+    /**Id of the task, 0 if the record is not about a task*/
+    uint8_t taskId;
+    /**UKERNEL_TRACE_CYCLES() when the record was taken*/
+    uint16_t cycles;
+    /**_counterMs when the record was taken*/
+    uint32_t tick;
+} uKernelTraceRecord;
+
 /**Function pointer on the task body.*/
 typedef void (*TaskBody)(void);
 
+/**Function pointer on the work deferred by an interrupt.*/
+typedef void (*uKernelWorkFunction)(void *argument);
+
+/**Item of the deferred work queue.*/
+typedef struct
+{
+    /**Function to be called by the scheduler*/
+    uKernelWorkFunction function;
+    /**Argument of the function*/
+    void *argument;
+} uKernelWorkItem;
+
 typedef struct _uKernelTaskDescriptor
 {
-    //    /**Pointer to the previous task in the list.*/
-    //    struct _uKernelTaskDescriptor *pTaskPrevious;
     /**Used to store the pointers to user's tasks*/
     TaskBody taskPointer;
     /**Used to store the interval between each task's run*/
@@ -63,24 +352,156 @@ typedef struct _uKernelTaskDescriptor
     uint32_t plannedTask;
     /**Used to store the status of the tasks*/
     uKernelTaskStatus taskStatus;
+#if UKERNEL_USE_EVENTS
+    /**Event flags posted to the task and not yet delivered*/
+    volatile uint8_t eventFlags;
+    /**Index of the next message to be written on the mailbox*/
+    volatile uint8_t mailboxHead;
+    /**Index of the next message to be read from the mailbox*/
+    volatile uint8_t mailboxTail;
+    /**Messages posted to the task*/
+    void *mailbox[UKERNEL_MAILBOX_SIZE];
+#endif
+#if UKERNEL_SCHEDULING_POLICY != UKERNEL_POLICY_ROUND_ROBIN
+    /**Worst case execution time in microseconds, 0 if not declared*/
+    uint16_t wcet;
+#endif
+#if UKERNEL_USE_MICROSECONDS
+    /**The period and the next run are in microseconds (low 32 bits)*/
+    bool microseconds;
+#endif
+#if UKERNEL_USE_GROUPS
+    /**The releases are kept on the grid of the period and phase*/
+    bool aligned;
+#endif
+#if UKERNEL_SCHEDULING_POLICY == UKERNEL_POLICY_FIXED_PRIORITY
+    /**Priority of the task, 0 is the highest*/
+    uint8_t priority;
+#endif
+#if UKERNEL_USE_STATISTICS
+    /**Number of releases of the task, the lost ones included*/
+    uint16_t releases;
+    /**Number of releases that finished after the deadline or were lost*/
+    uint16_t deadlineMisses;
+#endif
+#if UKERNEL_USE_WATCHDOG
+    /**Maximum time between check-ins in ms, 0 if the task is not critical*/
+    uint32_t watchdogTimeout;
+    /**_counterMs of the last check-in*/
+    volatile uint32_t lastCheckIn;
+#endif
+#if UKERNEL_USE_TRACE || UKERNEL_USE_WATCHDOG
+    /**Id of the task on the trace and watchdog records, given by uKernelAddTask*/
+    uint8_t taskId;
+#endif
+#if UKERNEL_USE_COROUTINES
+    /**Line where the coroutine of the task will continue, 0 to start over*/
+    uint16_t coroutineLine;
+#if UKERNEL_USE_GRID
+    /**The coroutine waits, its next release on the grid is kept apart*/
+    bool coroutineWaiting;
+    /**Next release on the grid while the coroutine waits*/
+    uint32_t coroutineRelease;
+#endif
+#endif
+    /**The task is on the list, set by uKernelAddTask and cleared by
+     * uKernelRemoveTask. Descriptors have to start zeroed (static storage).*/
+    bool onList;
+    /**Pointer to the previous task in the list.*/
+    struct _uKernelTaskDescriptor *pTaskPrevious;
     /**Pointer to the next task in the list.*/
     struct _uKernelTaskDescriptor *pTaskNext;
 } uKernelTaskDescriptor;
 
-extern uint32_t _counterMs;
+extern volatile uint32_t _counterMs;
 
 void uKernelInit(void);
 bool uKernelAddTask(uKernelTaskDescriptor *pTaskDescriptor,
                     void (*userTask)(void),
                     uint32_t taskInterval,
                     uKernelTaskStatus taskStatus);
+#if UKERNEL_SCHEDULING_POLICY != UKERNEL_POLICY_ROUND_ROBIN
+bool uKernelAddTaskWithWCET(uKernelTaskDescriptor *pTaskDescriptor,
+                            void (*userTask)(void),
+                            uint32_t taskInterval,
+                            uKernelTaskStatus taskStatus,
+                            uint16_t wcet);
+uint32_t uKernelGetUtilization(void);
+#endif
+#if UKERNEL_SCHEDULING_POLICY == UKERNEL_POLICY_FIXED_PRIORITY
+bool uKernelSetTaskPriority(uKernelTaskDescriptor *pTaskDescriptor,
+                            uint8_t priority);
+#endif
+#if UKERNEL_USE_MICROSECONDS
+bool uKernelAddTaskMicroseconds(uKernelTaskDescriptor *pTaskDescriptor,
+                                void (*userTask)(void),
+                                uint32_t taskInterval,
+                                uKernelTaskStatus taskStatus);
+#if UKERNEL_SCHEDULING_POLICY != UKERNEL_POLICY_ROUND_ROBIN
+bool uKernelAddTaskMicrosecondsWithWCET(uKernelTaskDescriptor *pTaskDescriptor,
+                                        void (*userTask)(void),
+                                        uint32_t taskInterval,
+                                        uKernelTaskStatus taskStatus,
+                                        uint16_t wcet);
+#endif
+#endif
+#if UKERNEL_USE_GROUPS
+bool uKernelAddGroupTask(uKernelTaskDescriptor *pTaskDescriptor,
+                         void (*userTask)(void),
+                         uint32_t taskInterval,
+                         uint32_t phase,
+                         uKernelTaskStatus taskStatus);
+bool uKernelAlignTask(uKernelTaskDescriptor *pTaskDescriptor, uint32_t phase);
+#endif
+#if UKERNEL_POOL_SIZE > 0
+uKernelTaskDescriptor *uKernelCreateTask(void (*userTask)(void),
+                                         uint32_t taskInterval,
+                                         uKernelTaskStatus taskStatus);
+#endif
 bool uKernelRemoveTask(uKernelTaskDescriptor *userTaskDescriptor);
+bool uKernelRemoveAllTasks(void);
 bool uKernelPauseTask(uKernelTaskDescriptor *pTaskDescriptor);
 bool uKernelResumeTask(uKernelTaskDescriptor *pTaskDescriptor);
 bool uKernelModifyTask(uKernelTaskDescriptor *pTaskDescriptor,
                                 uint32_t taskInterval,
                                 uKernelTaskStatus tStatus);
+uKernelTaskStatus uKernelGetTaskStatus(uKernelTaskDescriptor *pTaskDescriptor);
+uKernelTaskDescriptor *uKernelGetCurrentTask(void);
+uKernelTaskDescriptor *uKernelGetNextTask(uKernelTaskDescriptor *pTaskDescriptor);
+#if UKERNEL_USE_EVENTS
+void uKernelPostEvent(uKernelTaskDescriptor *pTaskDescriptor, uint8_t events);
+bool uKernelPostMessage(uKernelTaskDescriptor *pTaskDescriptor, void *message);
+uint8_t uKernelGetEvents(void);
+bool uKernelReceiveMessage(void **message);
+#endif
+#if UKERNEL_USE_COROUTINES
+void uKernelCoroutineWait(uKernelTaskDescriptor *pTaskDescriptor,
+                          uint32_t milliseconds);
+#endif
+#if UKERNEL_USE_DEFERRED_WORK
+bool uKernelDefer(uKernelWorkFunction function, void *argument);
+#endif
+#if UKERNEL_USE_TRACE
+void uKernelTrace(uKernelTraceType type, uint8_t taskId);
+void uKernelTraceClear(void);
+uint16_t uKernelTraceDump(void (*putByte)(uint8_t));
+#endif
+#if UKERNEL_USE_WATCHDOG
+bool uKernelSetTaskWatchdog(uKernelTaskDescriptor *pTaskDescriptor,
+                            uint32_t timeout);
+void uKernelWatchdogCheckIn(void);
+uint8_t uKernelGetWatchdogOffender(void);
+#endif
+#if UKERNEL_USE_TICKLESS
+uint32_t uKernelGetNextWakeup(void);
+void uKernelAdvanceTime(uint32_t milliseconds);
+#endif
+void uKernelTimerInterruptHandler(void);
+uint64_t uKernelGetTimeMs(void);
+uint64_t uKernelGetTimeUs(void);
+uint8_t uKernelSchedulerPass(void);
 void uKernelScheduler(void);
+void uKernelSleep(uint32_t milliseconds);
 void uKernelDelayMiliseconds(unsigned int delay);
 
 #ifdef	__cplusplus
@@ -0,0 +1,110 @@
+/**
+ *  @file           uKernelCoroutine.h
+ *  @author         Luis Maduro
+ *  @version        1.0
+ *  @date           03/05/2013
+ *  @copyright		GNU General Public License
+ *
+ *  @brief Stackless coroutines (protothread style) for the uKernel tasks.
+ *  A task body written between TASK_BEGIN() and TASK_END() can give the
+ *  processor back to the scheduler in the middle of a sequence and continue
+ *  from the same place on a later run, so long waits no longer block the
+ *  other tasks. The place to continue is kept in the task descriptor.
+ *
+ *  Rules:
+ *  - Local variables are lost at every wait, use static variables for the
+ *    values that must survive.
+ *  - Do not use switch statements between TASK_BEGIN() and TASK_END().
+ *  - Add the task as UKERNEL_SCHEDULED or UKERNEL_IMMEDIATESTART, one time and
+ *    event only tasks are not woken up by the waits.
+ *  - When TASK_END() is reached the coroutine starts over on the next period.
+ *    The waits do not move the releases of a task on a grid (EDF, rate
+ *    monotonic, groups or microseconds), the next period starts on time.
+ *  - Static tasks (uKernelStatic.h) have no descriptor and cannot be
+ *    coroutines, TASK_BEGIN() returns at once.
+ *
+ *  Example:
+ *  @code
+ *  void TemperatureTask(void)
+ *  {
+ *      static float temperature;
+ *
+ *      TASK_BEGIN();
+ *      DS18B20IssueTemperatureConvertion(&sensor);
+ *      TASK_SLEEP_MS(750);
+ *      DS18B20GetTemperature(&sensor, &temperature);
+ *      TASK_END();
+ *  }
+ *  @endcode
+ */
+
+#ifndef UKERNELCOROUTINE_H
+#define	UKERNELCOROUTINE_H
+
+#include "uKernel.h"
+
+#if !UKERNEL_USE_COROUTINES
+#error "uKernelCoroutine.h needs UKERNEL_USE_COROUTINES set to 1"
+#endif
+
+/**Starts the body of a coroutine task, returns if it is not a task of the
+ list (e.g. a static task, without a descriptor to keep the line).*/
+#define TASK_BEGIN()                                                        \
+    {                                                                       \
+        uKernelTaskDescriptor *_pCoroutineTask = uKernelGetCurrentTask();   \
+        if (_pCoroutineTask == NULL)                                        \
+        {                                                                   \
+            return;                                                         \
+        }                                                                   \
+        switch (_pCoroutineTask->coroutineLine)                             \
+        {                                                                   \
+        case 0:
+
+/**Ends the body of a coroutine task, the next run starts from the beginning.*/
+#define TASK_END()                                                          \
+        }                                                                   \
+        _pCoroutineTask->coroutineLine = 0;                                 \
+    }
+
+/**Gives the processor to the other tasks and continues on the next pass.*/
+#define TASK_YIELD()                                                        \
+    do                                                                      \
+    {                                                                       \
+        _pCoroutineTask->coroutineLine = __LINE__;                          \
+        uKernelCoroutineWait(_pCoroutineTask, 0);                           \
+        return;                                                             \
+        case __LINE__:;                                                     \
+    } while (0)
+
+/**Continues only when the condition is true, checked once on every pass.*/
+#define TASK_WAIT_UNTIL(condition)                                          \
+    do                                                                      \
+    {                                                                       \
+        _pCoroutineTask->coroutineLine = __LINE__;                          \
+        case __LINE__:                                                      \
+        if (!(condition))                                                   \
+        {                                                                   \
+            uKernelCoroutineWait(_pCoroutineTask, 0);                       \
+            return;                                                         \
+        }                                                                   \
+    } while (0)
+
+/**Continues after the given number of milliseconds, without busy waiting.*/
+#define TASK_SLEEP_MS(ms)                                                   \
+    do                                                                      \
+    {                                                                       \
+        _pCoroutineTask->coroutineLine = __LINE__;                          \
+        uKernelCoroutineWait(_pCoroutineTask, (ms));                        \
+        return;                                                             \
+        case __LINE__:;                                                     \
+    } while (0)
+
+/**Goes back to the beginning of the coroutine on the next period.*/
+#define TASK_RESTART()                                                      \
+    do                                                                      \
+    {                                                                       \
+        _pCoroutineTask->coroutineLine = 0;                                 \
+        return;                                                             \
+    } while (0)
+
+#endif	/* UKERNELCOROUTINE_H */
@@ -0,0 +1,196 @@
+/**
+ *  @file           uKernelStatic.c
+ *  @author         Luis Maduro
+ *  @version        1.0
+ *  @date           03/05/2013
+ *  @copyright		GNU General Public License
+ *
+ *  @brief Static task table of uKernel, see uKernelStatic.h.
+ */
+
+#include "uKernelStatic.h"
+
+#define UKERNEL_STATIC_PROTOTYPE(function, interval, status)                \
+    void function(void);
+#define UKERNEL_STATIC_ENTRY(function, interval, status)                    \
+    {function, interval, status},
+
+UKERNEL_STATIC_TASKS(UKERNEL_STATIC_PROTOTYPE)
+
+/**Functions and periods of the tasks, never change so they stay in ROM*/
+static const uKernelStaticTask staticTasks[UKERNEL_STATIC_NUMBER] = {
+    UKERNEL_STATIC_TASKS(UKERNEL_STATIC_ENTRY)
+};
+
+/**Next run of each task, the only RAM used with the status*/
+static uint32_t plannedTask[UKERNEL_STATIC_NUMBER];
+/**Status of each task*/
+static uint8_t taskStatus[UKERNEL_STATIC_NUMBER];
+/**A pass of the static tasks is running, the nested passes skip them*/
+static bool staticRunning;
+
+/**
+ * Starts the tasks with the status of the table, called by uKernelInit.
+ */
+void uKernelStaticInit(void)
+{
+    uint8_t taskId;
+    uint8_t status;
+
+    for (taskId = 0; taskId < UKERNEL_STATIC_NUMBER; taskId++)
+    {
+        status = staticTasks[taskId].taskStatus;
+
+        //no events for the static tasks
+        if (status > UKERNEL_ONETIME_IMMEDIATESTART)
+        {
+            status = UKERNEL_PAUSED;
+        }
+
+        plannedTask[taskId] = _counterMs
+                + ((status & 0x04) ? 0 : staticTasks[taskId].userTasksInterval);
+        taskStatus[taskId] = status & ~0x04;
+    }
+}
+
+/**
+ * Runs the static tasks that are due, in the order of the table. Called by
+ * uKernelSchedulerPass, the passes nested in a running one run nothing.
+ * @return Number of tasks executed.
+ */
+uint8_t uKernelStaticPass(void)
+{
+    uint8_t taskId;
+    uint8_t executed = 0;
+    uint32_t interval;
+
+    if (staticRunning)
+    {
+        return 0;
+    }
+
+    staticRunning = true;
+
+    for (taskId = 0; taskId < UKERNEL_STATIC_NUMBER; taskId++)
+    {
+        //this trick overrun the overflow of _counterMs
+        if ((taskStatus[taskId] == UKERNEL_PAUSED)
+                || (int32_t) (_counterMs - plannedTask[taskId]) < 0)
+        {
+            continue;
+        }
+
+        if (taskStatus[taskId] & UKERNEL_ONETIME)
+        {
+            taskStatus[taskId] = UKERNEL_PAUSED;
+        }
+        else
+        {
+            interval = staticTasks[taskId].userTasksInterval;
+
+            //next run on the grid of the period, unless it is a period late
+            plannedTask[taskId] += interval;
+            if ((int32_t) (_counterMs - plannedTask[taskId]) >= 0)
+            {
+                plannedTask[taskId] = _counterMs + interval;
+            }
+        }
+
+        staticTasks[taskId].taskPointer();
+        executed++;
+    }
+
+    staticRunning = false;
+
+    return executed;
+}
+
+/**
+ * Tells if a static task is running, uKernelSleep only waits in that case.
+ * @return True if called from a static task.
+ */
+bool uKernelStaticIsRunning(void)
+{
+    return staticRunning;
+}
+
+/**
+ * Time until the next static task is due, for the tickless idle.
+ * @return Milliseconds, 0 if a task is due and UINT32_MAX if all are paused.
+ */
+uint32_t uKernelStaticGetNextWakeup(void)
+{
+    uint8_t taskId;
+    uint32_t wakeup = UINT32_MAX;
+    int32_t remaining;
+
+    for (taskId = 0; taskId < UKERNEL_STATIC_NUMBER; taskId++)
+    {
+        if (taskStatus[taskId] != UKERNEL_PAUSED)
+        {
+            remaining = (int32_t) (plannedTask[taskId] - _counterMs);
+
+            if (remaining <= 0)
+            {
+                return 0;
+            }
+
+            if ((uint32_t) remaining < wakeup)
+            {
+                wakeup = remaining;
+            }
+        }
+    }
+
+    return wakeup;
+}
+
+/**
+ * Pauses a static task.
+ * @param taskId Id of the task, UKERNEL_TASK_<name>.
+ * @return True if all went well, false otherwise.
+ */
+bool uKernelStaticPauseTask(uKernelStaticTaskId taskId)
+{
+    if (taskId >= UKERNEL_STATIC_NUMBER)
+    {
+        return false;
+    }
+
+    taskStatus[taskId] = UKERNEL_PAUSED;
+
+    return true;
+}
+
+/**
+ * Resumes a static task, it runs after its period.
+ * @param taskId Id of the task, UKERNEL_TASK_<name>.
+ * @return True if all went well, false otherwise.
+ */
+bool uKernelStaticResumeTask(uKernelStaticTaskId taskId)
+{
+    if (taskId >= UKERNEL_STATIC_NUMBER)
+    {
+        return false;
+    }
+
+    plannedTask[taskId] = _counterMs + staticTasks[taskId].userTasksInterval;
+    taskStatus[taskId] = UKERNEL_SCHEDULED;
+
+    return true;
+}
+
+/**
+ * Gets the status of a static task.
+ * @param taskId Id of the task, UKERNEL_TASK_<name>.
+ * @return The status, UKERNEL_ERROR if the id is not valid.
+ */
+uKernelTaskStatus uKernelStaticGetTaskStatus(uKernelStaticTaskId taskId)
+{
+    if (taskId >= UKERNEL_STATIC_NUMBER)
+    {
+        return UKERNEL_ERROR;
+    }
+
+    return (uKernelTaskStatus) taskStatus[taskId];
+}
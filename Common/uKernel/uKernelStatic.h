@@ -0,0 +1,84 @@
+/**
+ *  @file           uKernelStatic.h
+ *  @author         Luis Maduro
+ *  @version        1.0
+ *  @date           03/05/2013
+ *  @copyright		GNU General Public License
+ *
+ *  @brief Static task table of uKernel, for the tasks whose function and
+ *  period never change.
+ *  The task set is declared at compile time in the file UKERNEL_STATIC_TASKS_FILE
+ *  (uKernelTasks.h by default, on the include path of the application) with
+ *  one line per task:
+ *  @code
+ *  #define UKERNEL_STATIC_TASKS(TASK)                                      \
+ *      TASK(Blink, 500, UKERNEL_SCHEDULED)                                 \
+ *      TASK(ReadSensors, 100, UKERNEL_IMMEDIATESTART)                      \
+ *      TASK(SendReport, 1000, UKERNEL_PAUSED)
+ *  @endcode
+ *  The functions and periods go to a const table (program memory on the
+ *  PIC18) and only the next run and the status of each task stay in RAM, 5
+ *  bytes per task instead of a whole uKernelTaskDescriptor. Build uKernel with
+ *  UKERNEL_USE_STATIC_TASKS set to 1 and add uKernelStatic.c, the tasks are
+ *  started by uKernelInit and run by uKernelScheduler before the tasks of the
+ *  list, in the order of the table. Each task has the id UKERNEL_TASK_<name>,
+ *  e.g. uKernelStaticResumeTask(UKERNEL_TASK_SendReport). Events, messages
+ *  and the per task options (statistics, watchdog, priorities...) need a
+ *  descriptor, use uKernelAddTask for those tasks.
+ *  uKernelSleep and the coroutines of uKernelCoroutine.h are not supported in
+ *  a static task either: uKernelSleep only waits there, without running the
+ *  other tasks, and a coroutine returns at TASK_BEGIN() without doing anything.
+ */
+
+#ifndef UKERNELSTATIC_H
+#define	UKERNELSTATIC_H
+
+#ifdef	__cplusplus
+extern "C"
+{
+#endif
+
+#include "uKernel.h"
+
+/**File of the application with the UKERNEL_STATIC_TASKS list.*/
+#ifndef UKERNEL_STATIC_TASKS_FILE
+#define UKERNEL_STATIC_TASKS_FILE   "uKernelTasks.h"
+#endif
+
+#include UKERNEL_STATIC_TASKS_FILE
+
+#define UKERNEL_STATIC_ID(function, interval, status)                       \
+    UKERNEL_TASK_##function,
+
+/**Ids of the static tasks, in the order of the table.*/
+typedef enum
+{
+    UKERNEL_STATIC_TASKS(UKERNEL_STATIC_ID)
+    /**Number of static tasks*/
+    UKERNEL_STATIC_NUMBER
+} uKernelStaticTaskId;
+
+/**Entry of the const table of the static tasks.*/
+typedef struct
+{
+    /**Function pointer on the task body*/
+    TaskBody taskPointer;
+    /**Interval between each run in milliseconds*/
+    uint32_t userTasksInterval;
+    /**Status of the task at uKernelInit*/
+    uKernelTaskStatus taskStatus;
+} uKernelStaticTask;
+
+void uKernelStaticInit(void);
+uint8_t uKernelStaticPass(void);
+uint32_t uKernelStaticGetNextWakeup(void);
+bool uKernelStaticIsRunning(void);
+bool uKernelStaticPauseTask(uKernelStaticTaskId taskId);
+bool uKernelStaticResumeTask(uKernelStaticTaskId taskId);
+uKernelTaskStatus uKernelStaticGetTaskStatus(uKernelStaticTaskId taskId);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* UKERNELSTATIC_H */
@@ -0,0 +1,363 @@
+/**
+ *  @file       I2CAsync.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       June 2013
+ *  @brief      Interrupt driven I2C master transactions on the MSSP.
+ *
+ *  Copyright (C) 2013  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "I2CAsync.h"
+
+/**Phases of a transaction, each one ends with an MSSP interrupt.*/
+enum
+{
+    I2C_STATE_IDLE,
+    I2C_STATE_START,
+    I2C_STATE_DEVICE_WRITE,
+    I2C_STATE_REGISTER,
+    I2C_STATE_DATA_WRITE,
+    I2C_STATE_RESTART,
+    I2C_STATE_DEVICE_READ,
+    I2C_STATE_DATA_READ,
+    I2C_STATE_ACK,
+    I2C_STATE_STOP
+};
+
+/**Transaction on the bus, the head of the queue*/
+static tI2CTransaction *volatile pHead = NULL;
+/**Last transaction of the queue*/
+static tI2CTransaction *pTail = NULL;
+/**Phase of the transaction on the bus*/
+static volatile unsigned char state = I2C_STATE_IDLE;
+/**Bytes of the transaction already transfered*/
+static unsigned char count;
+/**Status the transaction will end with*/
+static tI2CStatus result;
+
+/**
+ * Initiates the queue and enables the MSSP interrupt. The MSSP has to be
+ * configured as master before.
+ */
+void I2CAsyncInit(void)
+{
+    pHead = NULL;
+    pTail = NULL;
+    state = I2C_STATE_IDLE;
+    I2CASYNC_CLEAR_FLAG();
+    I2CASYNC_INTERRUPT_ON();
+}
+
+/**
+ * Starts the transaction at the head of the queue.
+ */
+static void I2CAsyncStartNext(void)
+{
+    if (pHead == NULL)
+    {
+        state = I2C_STATE_IDLE;
+        return;
+    }
+
+    pHead->status = I2C_TRANSACTION_RUNNING;
+
+    if (pHead->baud != 0)
+    {
+        I2CASYNC_SPEED(pHead->baud);
+    }
+
+    count = 0;
+    result = I2C_TRANSACTION_DONE;
+    state = I2C_STATE_START;
+    I2CASYNC_START();
+}
+
+/**
+ * Adds a transaction to the queue, it starts at once if the bus is free.
+ * @param pTransaction Transaction, filled by the caller.
+ * @return false if the transaction is already on the queue.
+ */
+bool I2CAsyncSubmit(tI2CTransaction *pTransaction)
+{
+    if ((pTransaction->status == I2C_TRANSACTION_QUEUED)
+            || (pTransaction->status == I2C_TRANSACTION_RUNNING))
+    {
+        return false;
+    }
+
+    pTransaction->status = I2C_TRANSACTION_QUEUED;
+    pTransaction->pNext = NULL;
+
+    I2CASYNC_INTERRUPT_OFF();
+
+    if (pHead == NULL)
+    {
+        pHead = pTransaction;
+        pTail = pTransaction;
+        I2CAsyncStartNext();
+    }
+    else
+    {
+        pTail->pNext = pTransaction;
+        pTail = pTransaction;
+    }
+
+    I2CASYNC_INTERRUPT_ON();
+
+    return true;
+}
+
+/**
+ * Fills and submits a transaction on consecutive registers.
+ * @param pTransaction Transaction, it has to stay alive until the callback.
+ * @param device Address of the slave NOT SHIFTED.
+ * @param baud Value of the baudrate register, 0 to keep the speed of the bus.
+ * @param address First register.
+ * @param length Number of bytes.
+ * @param data Data to write or buffer for the data read.
+ * @param direction I2C_Direction_Transmitter or I2C_Direction_Receiver.
+ * @param callback Called from the interrupt at the end, can be NULL.
+ * @return false if the transaction is already on the queue.
+ */
+static bool I2CAsyncQueue(tI2CTransaction *pTransaction, unsigned char device,
+                          unsigned char baud, unsigned char address,
+                          unsigned char length, unsigned char *data,
+                          unsigned char direction, tI2CCallback callback)
+{
+    if ((pTransaction->status == I2C_TRANSACTION_QUEUED)
+            || (pTransaction->status == I2C_TRANSACTION_RUNNING))
+    {
+        return false;
+    }
+
+    pTransaction->device = device;
+    pTransaction->baud = baud;
+    pTransaction->address = address;
+    pTransaction->length = length;
+    pTransaction->data = data;
+    pTransaction->direction = direction;
+    pTransaction->callback = callback;
+
+    return I2CAsyncSubmit(pTransaction);
+}
+
+/**
+ * Fills and submits a read of consecutive registers.
+ * @param pTransaction Transaction, it has to stay alive until the callback.
+ * @param device Address of the slave NOT SHIFTED.
+ * @param address First register to read.
+ * @param length Number of bytes to read.
+ * @param data Buffer for the data read.
+ * @param callback Called from the interrupt at the end, can be NULL.
+ * @return false if the transaction is already on the queue.
+ */
+bool I2CAsyncRead(tI2CTransaction *pTransaction, unsigned char device,
+                  unsigned char address, unsigned char length,
+                  unsigned char *data, tI2CCallback callback)
+{
+    return I2CAsyncQueue(pTransaction, device, 0, address, length, data,
+                         I2C_Direction_Receiver, callback);
+}
+
+/**
+ * Fills and submits a write of consecutive registers.
+ * @param pTransaction Transaction, it has to stay alive until the callback.
+ * @param device Address of the slave NOT SHIFTED.
+ * @param address First register to write.
+ * @param length Number of bytes to write.
+ * @param data Data to write, read by the interrupt (don't reuse it before the
+ *             callback).
+ * @param callback Called from the interrupt at the end, can be NULL.
+ * @return false if the transaction is already on the queue.
+ */
+bool I2CAsyncWrite(tI2CTransaction *pTransaction, unsigned char device,
+                   unsigned char address, unsigned char length,
+                   unsigned char *data, tI2CCallback callback)
+{
+    return I2CAsyncQueue(pTransaction, device, 0, address, length, data,
+                         I2C_Direction_Transmitter, callback);
+}
+
+#ifndef I2CASYNC_HOST
+
+/**
+ * Read of consecutive registers of a device handle, at the speed of the
+ * device.
+ * @see I2CAsyncRead
+ */
+bool I2CAsyncReadDevice(tI2CTransaction *pTransaction, tI2CDevice *pDevice,
+                        unsigned char address, unsigned char length,
+                        unsigned char *data, tI2CCallback callback)
+{
+    return I2CAsyncQueue(pTransaction, pDevice->address, pDevice->baud,
+                         address, length, data, I2C_Direction_Receiver,
+                         callback);
+}
+
+/**
+ * Write of consecutive registers of a device handle, at the speed of the
+ * device.
+ * @see I2CAsyncWrite
+ */
+bool I2CAsyncWriteDevice(tI2CTransaction *pTransaction, tI2CDevice *pDevice,
+                         unsigned char address, unsigned char length,
+                         unsigned char *data, tI2CCallback callback)
+{
+    return I2CAsyncQueue(pTransaction, pDevice->address, pDevice->baud,
+                         address, length, data, I2C_Direction_Transmitter,
+                         callback);
+}
+
+#endif
+
+/**
+ * Checks if all the transactions ended.
+ * @return true if the queue is empty.
+ */
+bool I2CAsyncIsIdle(void)
+{
+    return state == I2C_STATE_IDLE;
+}
+
+/**
+ * Ends the transaction on the bus with a stop.
+ * @param status Status of the transaction.
+ */
+static void I2CAsyncStop(tI2CStatus status)
+{
+    result = status;
+    state = I2C_STATE_STOP;
+    I2CASYNC_STOP();
+}
+
+/**
+ * State machine of the transactions, to be called from the interrupt routine
+ * when the MSSP flag is set.
+ */
+void I2CAsyncInterruptHandler(void)
+{
+    tI2CTransaction *pTransaction = pHead;
+
+    I2CASYNC_CLEAR_FLAG();
+
+    if (pTransaction == NULL)
+    {
+        state = I2C_STATE_IDLE;
+        return;
+    }
+
+    switch (state)
+    {
+        case I2C_STATE_START:
+            state = I2C_STATE_DEVICE_WRITE;
+            I2CASYNC_WRITE(pTransaction->device << 1);
+            break;
+
+        case I2C_STATE_DEVICE_WRITE:
+            if (I2CASYNC_NACKED())
+            {
+                I2CAsyncStop(I2C_TRANSACTION_NACK);
+                break;
+            }
+            state = I2C_STATE_REGISTER;
+            I2CASYNC_WRITE(pTransaction->address);
+            break;
+
+        case I2C_STATE_REGISTER:
+        case I2C_STATE_DATA_WRITE:
+            if (I2CASYNC_NACKED())
+            {
+                I2CAsyncStop(I2C_TRANSACTION_NACK);
+            }
+            else if (pTransaction->direction == I2C_Direction_Receiver)
+            {
+                state = I2C_STATE_RESTART;
+                I2CASYNC_RESTART();
+            }
+            else if (count < pTransaction->length)
+            {
+                state = I2C_STATE_DATA_WRITE;
+                I2CASYNC_WRITE(pTransaction->data[count++]);
+            }
+            else
+            {
+                I2CAsyncStop(I2C_TRANSACTION_DONE);
+            }
+            break;
+
+        case I2C_STATE_RESTART:
+            state = I2C_STATE_DEVICE_READ;
+            I2CASYNC_WRITE((pTransaction->device << 1) | 0x01);
+            break;
+
+        case I2C_STATE_DEVICE_READ:
+            if (I2CASYNC_NACKED())
+            {
+                I2CAsyncStop(I2C_TRANSACTION_NACK);
+            }
+            else if (pTransaction->length == 0)
+            {
+                I2CAsyncStop(I2C_TRANSACTION_DONE);
+            }
+            else
+            {
+                state = I2C_STATE_DATA_READ;
+                I2CASYNC_RECEIVE();
+            }
+            break;
+
+        case I2C_STATE_DATA_READ:
+            pTransaction->data[count++] = I2CASYNC_READ();
+            state = I2C_STATE_ACK;
+            //not ack on the last byte
+            I2CASYNC_ACK(count == pTransaction->length);
+            break;
+
+        case I2C_STATE_ACK:
+            if (count < pTransaction->length)
+            {
+                state = I2C_STATE_DATA_READ;
+                I2CASYNC_RECEIVE();
+            }
+            else
+            {
+                I2CAsyncStop(I2C_TRANSACTION_DONE);
+            }
+            break;
+
+        case I2C_STATE_STOP:
+            pHead = pTransaction->pNext;
+            pTransaction->status = result;
+
+            if (pTransaction->callback != NULL)
+            {
+                pTransaction->callback(pTransaction);
+            }
+
+            //the callback may have submitted another transaction
+            if (state == I2C_STATE_STOP)
+            {
+                I2CAsyncStartNext();
+            }
+            break;
+
+        default:
+            state = I2C_STATE_IDLE;
+            break;
+    }
+}
@@ -0,0 +1,158 @@
+/**
+ *  @file       I2CAsync.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       June 2013
+ *  @brief      Interrupt driven I2C master transactions on the MSSP.
+ *
+ *  Copyright (C) 2013  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  The caller fills a transaction (device, register, buffer, length and a
+ *  callback), submits it and goes on. The transactions are queued and the
+ *  MSSP interrupt sequences the start, address, register, data and stop of
+ *  each one, so the bus time is not spent in busy waits. Call
+ *  I2CAsyncInterruptHandler() from the interrupt routine:
+ *  @code
+ *  if (PIR1bits.SSPIF)
+ *  {
+ *      I2CAsyncInterruptHandler();
+ *  }
+ *  @endcode
+ *  Each transaction carries the address and the speed of its device (see
+ *  I2CAsyncReadDevice), so transactions to several devices run back to back
+ *  without selecting them in between.
+ *  The callback runs inside the interrupt, keep it short (e.g. uKernelPostEvent
+ *  or uKernelDefer). Don't mix it with the blocking I2CDevice functions while
+ *  a transaction is running.
+ *  Built with I2CASYNC_HOST the MSSP is replaced by the bus simulator of
+ *  Common/KernelHost/I2CBusSim.h, to test the state machine on Linux.
+ */
+
+#ifndef _I2CASYNC_H_
+#define _I2CASYNC_H_
+
+#include <stdbool.h>
+
+#ifdef I2CASYNC_HOST
+#include "../Common/KernelHost/I2CBusSim.h"
+
+#define I2CASYNC_START()            I2CBusSimStart()
+#define I2CASYNC_RESTART()          I2CBusSimRestart()
+#define I2CASYNC_STOP()             I2CBusSimStop()
+#define I2CASYNC_WRITE(data)        I2CBusSimWrite(data)
+#define I2CASYNC_RECEIVE()          I2CBusSimReceive()
+#define I2CASYNC_READ()             I2CBusSimRead()
+#define I2CASYNC_ACK(notAck)        I2CBusSimAck(notAck)
+#define I2CASYNC_NACKED()           I2CBusSimNacked()
+#define I2CASYNC_CLEAR_FLAG()
+#define I2CASYNC_INTERRUPT_ON()
+#define I2CASYNC_INTERRUPT_OFF()
+#define I2CASYNC_SPEED(baud)
+
+#define  I2C_Direction_Transmitter      0x00
+#define  I2C_Direction_Receiver         0x01
+#else
+#include "I2CDevice.h"
+
+/**Each of these starts one phase, the MSSP interrupt comes when it ends.*/
+#define I2CASYNC_START()            (I2CCON2bits.SEN = 1)
+#define I2CASYNC_RESTART()          (I2CCON2bits.RSEN = 1)
+#define I2CASYNC_STOP()             (I2CCON2bits.PEN = 1)
+#define I2CASYNC_WRITE(data)        (I2CBUF = (data))
+#define I2CASYNC_RECEIVE()          (I2CCON2bits.RCEN = 1)
+#define I2CASYNC_READ()             (I2CBUF)
+#define I2CASYNC_ACK(notAck)        (I2CCON2bits.ACKDT = (notAck), \
+                                     I2CCON2bits.ACKEN = 1)
+/**The slave did not acknowledge the last byte written.*/
+#define I2CASYNC_NACKED()           (I2CCON2bits.ACKSTAT)
+#define I2CASYNC_CLEAR_FLAG()       (PIR1bits.SSPIF = 0)
+#define I2CASYNC_INTERRUPT_ON()     (PIE1bits.SSPIE = 1)
+#define I2CASYNC_INTERRUPT_OFF()    (PIE1bits.SSPIE = 0)
+/**Sets the clock of the bus, between two transactions.*/
+#define I2CASYNC_SPEED(baud)        (I2CBAUDREGISTER = (baud))
+#endif
+
+/**
+ * @enum tI2CStatus
+ * @brief Status of a transaction.
+ */
+typedef enum
+{
+    /** The transaction was never submitted or the callback already ran.*/
+    I2C_TRANSACTION_IDLE,
+    /** Waiting on the queue.*/
+    I2C_TRANSACTION_QUEUED,
+    /** On the bus.*/
+    I2C_TRANSACTION_RUNNING,
+    /** All the bytes were transfered.*/
+    I2C_TRANSACTION_DONE,
+    /** The device did not acknowledge its address, the register or a byte.*/
+    I2C_TRANSACTION_NACK
+} tI2CStatus;
+
+struct _tI2CTransaction;
+
+/**Called from the interrupt when a transaction ends.*/
+typedef void (*tI2CCallback)(struct _tI2CTransaction *pTransaction);
+
+/**
+ * @struct _tI2CTransaction
+ * @brief Transaction on the bus, it has to stay alive until its callback.
+ */
+typedef struct _tI2CTransaction
+{
+    /** Address of the slave NOT SHIFTED*/
+    unsigned char device;
+    /** Value of the baudrate register, 0 to keep the speed of the bus*/
+    unsigned char baud;
+    /** First register to read or write*/
+    unsigned char address;
+    /** Data to write or buffer for the data read*/
+    unsigned char *data;
+    /** Number of bytes*/
+    unsigned char length;
+    /** I2C_Direction_Transmitter to write, I2C_Direction_Receiver to read*/
+    unsigned char direction;
+    /** Called when the transaction ends, can be NULL*/
+    tI2CCallback callback;
+    /** Free for the caller, e.g. the uKernel task to be posted*/
+    void *context;
+    /** Status, set by the driver*/
+    volatile tI2CStatus status;
+    /** Next transaction on the queue*/
+    struct _tI2CTransaction *pNext;
+} tI2CTransaction;
+
+void I2CAsyncInit(void);
+bool I2CAsyncSubmit(tI2CTransaction *pTransaction);
+bool I2CAsyncRead(tI2CTransaction *pTransaction, unsigned char device,
+                  unsigned char address, unsigned char length,
+                  unsigned char *data, tI2CCallback callback);
+bool I2CAsyncWrite(tI2CTransaction *pTransaction, unsigned char device,
+                   unsigned char address, unsigned char length,
+                   unsigned char *data, tI2CCallback callback);
+#ifndef I2CASYNC_HOST
+bool I2CAsyncReadDevice(tI2CTransaction *pTransaction, tI2CDevice *pDevice,
+                        unsigned char address, unsigned char length,
+                        unsigned char *data, tI2CCallback callback);
+bool I2CAsyncWriteDevice(tI2CTransaction *pTransaction, tI2CDevice *pDevice,
+                         unsigned char address, unsigned char length,
+                         unsigned char *data, tI2CCallback callback);
+#endif
+bool I2CAsyncIsIdle(void);
+void I2CAsyncInterruptHandler(void);
+
+#endif /* _I2CASYNC_H_ */
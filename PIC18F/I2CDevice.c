@@ -39,6 +39,25 @@ unsigned char deviceAddressRead;
 /**This variable contains the address to write to the current device.*/
 unsigned char deviceAddressWrite;
 
+/**Handle of the current device, 0 if it was set by its address*/
+static tI2CDevice *pCurrent = 0;
+/**Speed of the bus for the devices set by their address*/
+static unsigned char addressBaud;
+
+#if I2CDEVICE_USE_CACHE
+/**Caches of all the devices*/
+static tI2CRegisterCache *pCacheList = 0;
+/**First cache of the current device on the list, 0 if it has none*/
+static tI2CRegisterCache *pCache = 0;
+
+static tI2CRegisterCache *I2CDeviceCacheFind(unsigned char address);
+static void I2CDeviceCacheUpdate(unsigned char address,
+                                 unsigned char length,
+                                 unsigned char *data);
+static unsigned char I2CDeviceCacheLookup(unsigned char address,
+                                          unsigned char *value);
+#endif
+
 /**
  * Sends a start condition to the I2C bus.
  * @warning Hardware specific!
@@ -167,6 +186,87 @@ void I2CDeviceSetDeviceAddress(unsigned char address)
 {
     deviceAddressRead = (address << 1) | 0x01;
     deviceAddressWrite = (address << 1) & 0xFE;
+
+    //back to the speed the bus had before the handles
+    if ((pCurrent != 0) && (pCurrent->baud != 0))
+    {
+        I2CBAUDREGISTER = addressBaud;
+    }
+    pCurrent = 0;
+
+#if I2CDEVICE_USE_CACHE
+    for (pCache = pCacheList; pCache != 0; pCache = pCache->pNext)
+    {
+        if (pCache->device == address)
+        {
+            break;
+        }
+    }
+#endif
+}
+
+/**
+ * Makes a device handle the current device of the library, with its speed and
+ * its cache. Selecting the device that is already current costs nothing.
+ * @param pDevice Handle of the device, see I2CDEVICE_HANDLE.
+ */
+void I2CDeviceSelect(tI2CDevice *pDevice)
+{
+    if (pDevice == pCurrent)
+    {
+        return;
+    }
+
+    if (pCurrent == 0)
+    {
+        addressBaud = I2CBAUDREGISTER;
+    }
+
+    deviceAddressRead = (pDevice->address << 1) | 0x01;
+    deviceAddressWrite = (pDevice->address << 1) & 0xFE;
+
+    if ((pDevice->baud != 0) && (I2CBAUDREGISTER != pDevice->baud))
+    {
+        I2CBAUDREGISTER = pDevice->baud;
+    }
+
+#if I2CDEVICE_USE_CACHE
+    pCache = pDevice->pCache;
+#endif
+
+    pCurrent = pDevice;
+}
+
+/**
+ * Read multiple bytes from the registers of a device.
+ * @param pDevice Handle of the device
+ * @param address First register address to read from
+ * @param length Number of bytes to read
+ * @param data Buffer to store read data in
+ */
+void I2CDeviceReadRegisters(tI2CDevice *pDevice,
+                            unsigned char address,
+                            unsigned char length,
+                            unsigned char *data)
+{
+    I2CDeviceSelect(pDevice);
+    I2CDeviceReadBytes(address, length, data);
+}
+
+/**
+ * Write multiple bytes to the registers of a device.
+ * @param pDevice Handle of the device
+ * @param address First register address to write to
+ * @param length Number of bytes to write
+ * @param data Buffer to copy new data from
+ */
+void I2CDeviceWriteRegisters(tI2CDevice *pDevice,
+                             unsigned char address,
+                             unsigned char length,
+                             unsigned char *data)
+{
+    I2CDeviceSelect(pDevice);
+    I2CDeviceWriteBytes(address, length, data);
 }
 
 /**
@@ -203,6 +303,10 @@ void I2CDeviceReadBytes(unsigned char address,
     }
 
     I2CStop();
+
+#if I2CDEVICE_USE_CACHE
+    I2CDeviceCacheUpdate(address, length, data);
+#endif
 }
 
 /**
@@ -226,6 +330,10 @@ void I2CDeviceWriteBytes(unsigned char address,
         I2CWrite(data[i]);
     }
     I2CStop();
+
+#if I2CDEVICE_USE_CACHE
+    I2CDeviceCacheUpdate(address, length, data);
+#endif
 }
 
 /**
@@ -284,6 +392,26 @@ unsigned char I2CDeviceReadByte(unsigned char address)
     return b;
 }
 
+/**
+ * Value of a register that is going to be modified, from the cache if it is
+ * known, from the bus otherwise.
+ * @param address Register address to read from
+ * @return Byte value of the register
+ */
+static unsigned char I2CDeviceReadShadow(unsigned char address)
+{
+#if I2CDEVICE_USE_CACHE
+    unsigned char b;
+
+    if (I2CDeviceCacheLookup(address, &b))
+    {
+        return b;
+    }
+#endif
+
+    return I2CDeviceReadByte(address);
+}
+
 /**
  * Write a single bit to a device register.
  * @param address Register address to write to
@@ -296,7 +424,7 @@ void I2CDeviceWriteBit(unsigned char address,
 {
     unsigned char b;
 
-    b = I2CDeviceReadByte(address);
+    b = I2CDeviceReadShadow(address);
 
     b = value ? (b | (1 << _bit)) : (b & ~(1 << _bit));
 
@@ -328,7 +456,7 @@ void I2CDeviceWriteBits(unsigned char address,
     unsigned char b;
     unsigned char mask;
 
-    b = I2CDeviceReadByte(address);
+    b = I2CDeviceReadShadow(address);
 
     mask = (0xFF << (8 - length)) | (0xFF >> (bitStart + length - 1));
 
@@ -353,3 +481,257 @@ void I2CDeviceWriteByte(unsigned char address,
 {
     I2CDeviceWriteBytes(address, 1, &value);
 }
+
+/**
+ * Applies a table of register settings to the current device. The entries
+ * are applied in order, consecutive entries on contiguous registers (or on
+ * the same register) are merged in one auto increment burst. A register whose
+ * first entry has a mask other than 0xFF keeps its other bits, so the run is
+ * read first in one burst (unless the cache knows all of it).
+ * @param pSequence Table of settings, usually const.
+ * @param length Number of entries of the table.
+ */
+void I2CDeviceWriteSequence(const tI2CRegisterSetting *pSequence,
+                            unsigned char length)
+{
+    unsigned char data[I2CDEVICE_SEQUENCE_BURST];
+    unsigned char merge[I2CDEVICE_SEQUENCE_BURST];
+    unsigned char first;
+    unsigned char count;
+    unsigned char readNeeded;
+    unsigned char index;
+    unsigned char i;
+    unsigned char j;
+
+    i = 0;
+
+    while (i < length)
+    {
+        //collect the run of contiguous registers
+        first = pSequence[i].address;
+        count = 0;
+        readNeeded = 0;
+
+        for (j = i; j < length; j++)
+        {
+            index = pSequence[j].address - first;
+
+            if ((index == count) && (count < I2CDEVICE_SEQUENCE_BURST))
+            {
+                merge[count] = (pSequence[j].mask != 0xFF);
+                count++;
+            }
+            else if ((count == 0) || (index != count - 1))
+            {
+                break;
+            }
+        }
+
+        //the old values of the registers that are only partly written
+        for (index = 0; index < count; index++)
+        {
+#if I2CDEVICE_USE_CACHE
+            if (merge[index]
+                    && !I2CDeviceCacheLookup(first + index, &data[index]))
+            {
+                readNeeded = 1;
+            }
+#else
+            readNeeded |= merge[index];
+#endif
+        }
+
+        if (readNeeded)
+        {
+            I2CDeviceReadBytes(first, count, data);
+        }
+
+        for (; i < j; i++)
+        {
+            index = pSequence[i].address - first;
+            data[index] = (data[index] & ~pSequence[i].mask)
+                    | (pSequence[i].value & pSequence[i].mask);
+        }
+
+        I2CDeviceWriteBytes(first, count, data);
+    }
+}
+
+#if I2CDEVICE_USE_CACHE
+
+/**
+ * Gets the cache of the current device that keeps a register. The caches of a
+ * device follow its first one on the list.
+ * @param address Register address
+ * @return The cache or 0 if the register is not cached.
+ */
+static tI2CRegisterCache *I2CDeviceCacheFind(unsigned char address)
+{
+    tI2CRegisterCache *pSearch;
+
+    for (pSearch = pCache; pSearch != 0; pSearch = pSearch->pNext)
+    {
+        if ((pSearch->device == pCache->device)
+                && ((unsigned char) (address - pSearch->first)
+                    < pSearch->length))
+        {
+            return pSearch;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Keeps the registers of a range that were read or written on the bus.
+ * @param address First register address
+ * @param length Number of bytes
+ * @param data Values of the registers
+ */
+static void I2CDeviceCacheUpdate(unsigned char address,
+                                 unsigned char length,
+                                 unsigned char *data)
+{
+    unsigned char i;
+    unsigned char index;
+    tI2CRegisterCache *pFound;
+
+    if (pCache == 0)
+    {
+        return;
+    }
+
+    for (i = 0; i < length; i++)
+    {
+        pFound = I2CDeviceCacheFind(address + i);
+
+        if (pFound != 0)
+        {
+            index = (unsigned char) (address + i - pFound->first);
+            pFound->values[index] = data[i];
+            pFound->valid[index >> 3] |= (1 << (index & 0x07));
+        }
+    }
+}
+
+/**
+ * Gets the value of a register from the cache of the current device.
+ * @param address Register address
+ * @param value Filled with the value of the register if it is known
+ * @return 1 if the value is known, 0 if it has to be read from the bus
+ */
+static unsigned char I2CDeviceCacheLookup(unsigned char address,
+                                          unsigned char *value)
+{
+    unsigned char index;
+    tI2CRegisterCache *pFound;
+
+    if (pCache == 0)
+    {
+        return 0;
+    }
+
+    pFound = I2CDeviceCacheFind(address);
+    if (pFound == 0)
+    {
+        return 0;
+    }
+
+    index = address - pFound->first;
+
+    if (pFound->valid[index >> 3] & (1 << (index & 0x07)))
+    {
+        *value = pFound->values[index];
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Gives a cache, declared with I2CDEVICE_CACHE, to the current device (set by
+ * I2CDeviceSetDeviceAddress or I2CDeviceSelect). It starts empty and is
+ * filled by the reads and writes on the bus. A device can have several caches,
+ * e.g. to leave out the status registers between its configuration registers.
+ * @param pNewCache Cache of the device.
+ */
+void I2CDeviceCacheAttach(tI2CRegisterCache *pNewCache)
+{
+    tI2CRegisterCache *pSearch;
+    unsigned char i;
+
+    pNewCache->device = deviceAddressWrite >> 1;
+
+    for (pSearch = pCacheList; pSearch != 0; pSearch = pSearch->pNext)
+    {
+        if (pSearch == pNewCache)
+        {
+            break;
+        }
+    }
+
+    if (pSearch == 0)
+    {
+        pNewCache->pNext = pCacheList;
+        pCacheList = pNewCache;
+    }
+
+    //the first cache of the device on the list, the others follow it
+    for (pCache = pCacheList; pCache != 0; pCache = pCache->pNext)
+    {
+        if (pCache->device == pNewCache->device)
+        {
+            break;
+        }
+    }
+
+    if (pCurrent != 0)
+    {
+        pCurrent->pCache = pCache;
+    }
+
+    for (i = 0; i < (pNewCache->length + 7) / 8; i++)
+    {
+        pNewCache->valid[i] = 0;
+    }
+}
+
+/**
+ * Forgets the registers of the current device, e.g. after a reset of the
+ * device or a write that changes other registers.
+ */
+void I2CDeviceCacheInvalidate(void)
+{
+    unsigned char i;
+    tI2CRegisterCache *pSearch;
+
+    for (pSearch = pCache; pSearch != 0; pSearch = pSearch->pNext)
+    {
+        if (pSearch->device == pCache->device)
+        {
+            for (i = 0; i < (pSearch->length + 7) / 8; i++)
+            {
+                pSearch->valid[i] = 0;
+            }
+        }
+    }
+}
+
+/**
+ * Reads all the cached registers of the current device, one burst per cache.
+ */
+void I2CDeviceCacheRefresh(void)
+{
+    tI2CRegisterCache *pSearch;
+
+    for (pSearch = pCache; pSearch != 0; pSearch = pSearch->pNext)
+    {
+        if (pSearch->device == pCache->device)
+        {
+            I2CDeviceReadBytes(pSearch->first, pSearch->length,
+                               pSearch->values);
+        }
+    }
+}
+
+#endif
@@ -47,6 +47,8 @@ extern unsigned char deviceAddressWrite;
  SYSTEM_OSCILATOR must contain the value of the oscilator. Check the formula for
  different microcontrollers.*/
 #define I2CBAUDVALUE        (((SYSTEM_OSCILATOR/4)/I2C_SPEED)-1)
+/**Value of the baudrate register for any speed, see I2CBAUDVALUE.*/
+#define I2CBAUD(speed)      (((SYSTEM_OSCILATOR/4)/(speed))-1)
 /**Configure the clock pin associated with the I2C*/
 #define I2CSCLPIN           TRISBbits.TRISB6
 /**Configure the data pin associated with the I2C*/
@@ -65,6 +67,92 @@ extern unsigned char deviceAddressWrite;
 #define  I2C_Direction_Transmitter      0x00
 #define  I2C_Direction_Receiver         0x01
 
+/**Keeps a shadow of the configuration registers of the devices, so
+ I2CDeviceWriteBit(s) don't read them from the bus. See I2CDeviceCacheAttach.*/
+#ifndef I2CDEVICE_USE_CACHE
+#define I2CDEVICE_USE_CACHE 0
+#endif
+
+#if I2CDEVICE_USE_CACHE
+/**
+ * @struct _tI2CRegisterCache
+ * @brief Shadow of a range of registers of one device.
+ */
+typedef struct _tI2CRegisterCache
+{
+    /** Address of the device NOT SHIFTED, set by I2CDeviceCacheAttach*/
+    unsigned char device;
+    /** First register of the range*/
+    unsigned char first;
+    /** Number of registers of the range*/
+    unsigned char length;
+    /** Last value read or written of each register*/
+    unsigned char *values;
+    /** One bit per register, set if its value is known*/
+    unsigned char *valid;
+    /** Next cache of the list*/
+    struct _tI2CRegisterCache *pNext;
+} tI2CRegisterCache;
+
+/**Declares a static cache of the registers first to last of a device. Only
+ registers that the device never changes by itself (configuration, not status
+ or self clearing bits) can be cached, use one cache per range of them.*/
+#define I2CDEVICE_CACHE(name, first, last)                                  \
+    static unsigned char name##Values[(last) - (first) + 1];               \
+    static unsigned char name##Valid[((last) - (first) + 8) / 8];          \
+    static tI2CRegisterCache name = {0, (first), (last) - (first) + 1,     \
+                                     name##Values, name##Valid, 0}
+#endif
+
+/**Longest burst of I2CDeviceWriteSequence, in registers.*/
+#ifndef I2CDEVICE_SEQUENCE_BURST
+#define I2CDEVICE_SEQUENCE_BURST 8
+#endif
+
+/**
+ * @struct tI2CRegisterSetting
+ * @brief Entry of a table of register settings, see I2CDeviceWriteSequence.
+ */
+typedef struct
+{
+    /** Register address*/
+    unsigned char address;
+    /** Bits of the register that are written, 0xFF for the whole byte*/
+    unsigned char mask;
+    /** Value of the bits, already shifted to their position*/
+    unsigned char value;
+} tI2CRegisterSetting;
+
+/**Mask and value of a field, with the bitStart and length of
+ I2CDeviceWriteBits, for the tables of I2CDeviceWriteSequence.*/
+#define I2CDEVICE_BITS_MASK(bitStart, length)                               \
+    ((unsigned char) (((1 << (length)) - 1) << ((bitStart) - (length) + 1)))
+#define I2CDEVICE_BITS(bitStart, length, value)                             \
+    ((unsigned char) (((value) << ((bitStart) - (length) + 1))             \
+                      & I2CDEVICE_BITS_MASK(bitStart, length)))
+
+struct _tI2CRegisterCache;
+
+/**
+ * @struct tI2CDevice
+ * @brief Handle of a device on the bus, with its own address, speed and
+ * register cache. Declare it with I2CDEVICE_HANDLE and make it current with
+ * I2CDeviceSelect, instead of I2CDeviceSetDeviceAddress.
+ */
+typedef struct
+{
+    /** Address of the device NOT SHIFTED*/
+    unsigned char address;
+    /** Value of the baudrate register, 0 to keep the speed of the bus*/
+    unsigned char baud;
+    /** Register cache of the device, see I2CDeviceCacheAttach*/
+    struct _tI2CRegisterCache *pCache;
+} tI2CDevice;
+
+/**Initializer of a tI2CDevice, e.g.
+ tI2CDevice magnetometer = I2CDEVICE_HANDLE(0x1E, 400000);*/
+#define I2CDEVICE_HANDLE(address, speed)    {(address), I2CBAUD(speed), 0}
+
 void I2CInit(void);
 void I2CStart(void);
 void I2CRestart(void);
@@ -75,6 +163,15 @@ void I2CSendAddress(unsigned char Address, unsigned char I2C_Direction);
 unsigned char I2CWrite(unsigned char data_out);
 unsigned char I2CRead(void);
 void I2CDeviceSetDeviceAddress(unsigned char address);
+void I2CDeviceSelect(tI2CDevice *pDevice);
+void I2CDeviceReadRegisters(tI2CDevice *pDevice,
+                            unsigned char address,
+                            unsigned char length,
+                            unsigned char *data);
+void I2CDeviceWriteRegisters(tI2CDevice *pDevice,
+                             unsigned char address,
+                             unsigned char length,
+                             unsigned char *data);
 unsigned char I2CDeviceReadBit(unsigned char address,
                                unsigned char _bit);
 unsigned char I2CDeviceReadBits(unsigned char address,
@@ -96,5 +193,12 @@ void I2CDeviceWriteByte(unsigned char address,
 void I2CDeviceWriteBytes(unsigned char address,
                          unsigned char length,
                          unsigned char *data);
+void I2CDeviceWriteSequence(const tI2CRegisterSetting *pSequence,
+                            unsigned char length);
+#if I2CDEVICE_USE_CACHE
+void I2CDeviceCacheAttach(tI2CRegisterCache *pNewCache);
+void I2CDeviceCacheInvalidate(void);
+void I2CDeviceCacheRefresh(void);
+#endif
 
 #endif /* _I2CDEV_H_ */
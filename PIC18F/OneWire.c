@@ -116,6 +116,21 @@ sample code bearing this copyright.
 
 #include "OneWire.h"
 
+// Overdrive timings in tenths of microseconds, Maxim AN126
+#define OD_WRITE_ONE_LOW        10      // A
+#define OD_WRITE_ONE_HIGH       75      // B
+#define OD_WRITE_ZERO_LOW       75      // C
+#define OD_WRITE_ZERO_HIGH      25      // D
+#define OD_READ_SAMPLE          10      // E
+#define OD_READ_HIGH            70      // F
+#define OD_RESET_LOW            70      // H, in microseconds
+#define OD_RESET_SAMPLE         85      // I
+#define OD_RESET_END            40      // J, in microseconds
+
+#define OD_DELAY(tenths)        _delay((ONEWIRE_CYCLES_PER_US * (tenths)) / 10)
+
+static unsigned char speed = ONEWIRE_SPEED_STANDARD;
+
 void OneWireInit(void)
 {
     //Timer 3 incretments at 1us @ 32MHz
@@ -138,6 +153,8 @@ void OneWireInit(void)
 
     T3CONbits.TMR3ON = 0;
 
+    speed = ONEWIRE_SPEED_STANDARD;
+
 #if ONEWIRE_SEARCH
     OneWireResetSearch();
 #endif
@@ -186,6 +203,20 @@ unsigned char OneWireReset(void)
     }
     while (!ONEWIRE_PIN_READ);
 
+    if (speed == ONEWIRE_SPEED_OVERDRIVE)
+    {
+        InterruptsOFF();
+        ONEWIRE_PIN_WRITE = LOW;
+        ONEWIRE_PIN_DIRECTION = OUTPUT; // drive output low
+        delayMicroseconds(OD_RESET_LOW);
+        ONEWIRE_PIN_DIRECTION = INPUT; // allow it to float
+        OD_DELAY(OD_RESET_SAMPLE);
+        r = !ONEWIRE_PIN_READ;
+        InterruptsON();
+        delayMicroseconds(OD_RESET_END);
+        return r;
+    }
+
     InterruptsOFF();
     ONEWIRE_PIN_WRITE = LOW;
     ONEWIRE_PIN_DIRECTION = OUTPUT; // drive output low
@@ -207,6 +238,27 @@ unsigned char OneWireReset(void)
 
 void OneWireWriteBit(unsigned char v)
 {
+    if (speed == ONEWIRE_SPEED_OVERDRIVE)
+    {
+        InterruptsOFF();
+        ONEWIRE_PIN_WRITE = LOW;
+        ONEWIRE_PIN_DIRECTION = OUTPUT; // drive output low
+        if (v & 1)
+        {
+            OD_DELAY(OD_WRITE_ONE_LOW);
+            ONEWIRE_PIN_WRITE = HIGH; // drive output high
+            OD_DELAY(OD_WRITE_ONE_HIGH);
+        }
+        else
+        {
+            OD_DELAY(OD_WRITE_ZERO_LOW);
+            ONEWIRE_PIN_WRITE = HIGH; // drive output high
+            OD_DELAY(OD_WRITE_ZERO_HIGH);
+        }
+        InterruptsON();
+        return;
+    }
+
     if (v & 1)
     {
         InterruptsOFF();
@@ -238,6 +290,20 @@ unsigned char OneWireReadBit(void)
 {
     unsigned char r;
 
+    if (speed == ONEWIRE_SPEED_OVERDRIVE)
+    {
+        InterruptsOFF();
+        ONEWIRE_PIN_DIRECTION = OUTPUT;
+        ONEWIRE_PIN_WRITE = LOW;
+        OD_DELAY(OD_WRITE_ONE_LOW);
+        ONEWIRE_PIN_DIRECTION = INPUT; // let pin float, pull up will raise
+        OD_DELAY(OD_READ_SAMPLE);
+        r = ONEWIRE_PIN_READ;
+        OD_DELAY(OD_READ_HIGH);
+        InterruptsON();
+        return r;
+    }
+
     InterruptsOFF();
     ONEWIRE_PIN_DIRECTION = OUTPUT;
     ONEWIRE_PIN_WRITE = LOW;
@@ -318,6 +384,54 @@ void OneWireSkip(void)
     OneWireWrite(0xCC); // Skip ROM
 }
 
+//
+// Set the speed of the slots. The overdrive slots are timed with instruction
+// cycles, with the interrupts off, because the timer is too slow for them.
+//
+void OneWireSpeed(unsigned char new_speed)
+{
+    speed = new_speed;
+}
+
+//
+// Do an overdrive ROM skip, the reset and the command are sent at standard
+// speed and the master stays in overdrive. The next reset is an overdrive
+// one.
+//
+unsigned char OneWireOverdriveSkip(void)
+{
+    speed = ONEWIRE_SPEED_STANDARD;
+
+    if (!OneWireReset())
+        return 0;
+
+    OneWireWrite(OVERDRIVE_SKIP_ROM_COMMAND);
+    speed = ONEWIRE_SPEED_OVERDRIVE;
+
+    return 1;
+}
+
+//
+// Do an overdrive ROM select, the ROM code is sent at overdrive speed.
+//
+unsigned char OneWireOverdriveMatch(tLaseredROMCode *device)
+{
+    unsigned char i;
+
+    speed = ONEWIRE_SPEED_STANDARD;
+
+    if (!OneWireReset())
+        return 0;
+
+    OneWireWrite(OVERDRIVE_MATCH_ROM_COMMAND);
+    speed = ONEWIRE_SPEED_OVERDRIVE;
+
+    for (i = 0; i < 8; i++)
+        OneWireWrite(device->Array[i]);
+
+    return 1;
+}
+
 #if ONEWIRE_SEARCH
 
 //
@@ -370,7 +484,7 @@ void OneWireTargetSearch(unsigned char family_code)
 //        FALSE : device not found, end of search
 //
 
-unsigned char OneWireSearch()
+static unsigned char OneWireSearchCommand(unsigned char command)
 {
     unsigned char id_bit_number;
     unsigned char last_zero, rom_byte_number, search_result;
@@ -399,7 +513,7 @@ unsigned char OneWireSearch()
         }
 
         // issue the search command
-        OneWireWrite(0xF0);
+        OneWireWrite(command);
 
         // loop to do the search
         do
@@ -488,6 +602,62 @@ unsigned char OneWireSearch()
     return search_result;
 }
 
+unsigned char OneWireSearch(void)
+{
+    return OneWireSearchCommand(0xF0); // Search ROM
+}
+
+//
+// Same as OneWireSearch but only the devices with an alarm flag answer, e.g.
+// the DS18B20 out of its TH/TL limits.
+//
+
+unsigned char OneWireAlarmSearch(void)
+{
+    return OneWireSearchCommand(0xEC); // Alarm Search
+}
+
+/**
+ * @brief Checks if a device is on the bus with one targeted search pass, it
+ *        follows the ROM code at every discrepancy (Maxim AN187 OWVerify).
+ *        The search state is kept, so it can be called in the middle of a
+ *        search.
+ * @param device ROM code of the device.
+ * @return TRUE if the device answered.
+ */
+unsigned char OneWireVerify(tLaseredROMCode *device)
+{
+    unsigned char rom_backup[8];
+    unsigned char ld_backup, ldf_backup, lfd_backup;
+    unsigned char i, rslt;
+
+    for (i = 0; i < 8; i++)
+    {
+        rom_backup[i] = ROM_NO[i];
+        ROM_NO[i] = device->Array[i];
+    }
+    ld_backup = LastDiscrepancy;
+    ldf_backup = LastDeviceFlag;
+    lfd_backup = LastFamilyDiscrepancy;
+
+    LastDiscrepancy = 64;
+    LastDeviceFlag = FALSE;
+
+    rslt = OneWireSearch();
+
+    for (i = 0; i < 8; i++)
+    {
+        if (ROM_NO[i] != device->Array[i])
+            rslt = FALSE;
+        ROM_NO[i] = rom_backup[i];
+    }
+    LastDiscrepancy = ld_backup;
+    LastDeviceFlag = ldf_backup;
+    LastFamilyDiscrepancy = lfd_backup;
+
+    return rslt;
+}
+
 /**
  * @brief Performs a full search for devices on 1-Wire Bus.
  * @param romcode Pointer to Lasered_ROM_Code type array to store the devices
@@ -529,108 +699,3 @@ void OneWireFindAllDevicesOnBus(tLaseredROMCode *romcode, unsigned char *num_dev
     *num_devices = devNum;
 }
 #endif
-
-#if ONEWIRE_CRC
-// The 1-Wire CRC scheme is described in Maxim Application Note 27:
-// "Understanding and Using Cyclic Redundancy Checks with Maxim iButton Products"
-//
-
-#if ONEWIRE_CRC8_TABLE
-// This table comes from Dallas sample code where it is freely reusable,
-// though Copyright (C) 2000 Dallas Semiconductor Corporation
-static const unsigned char dscrc_table[] = {
-    0, 94, 188, 226, 97, 63, 221, 131, 194, 156, 126, 32, 163, 253, 31, 65,
-    157, 195, 33, 127, 252, 162, 64, 30, 95, 1, 227, 189, 62, 96, 130, 220,
-    35, 125, 159, 193, 66, 28, 254, 160, 225, 191, 93, 3, 128, 222, 60, 98,
-    190, 224, 2, 92, 223, 129, 99, 61, 124, 34, 192, 158, 29, 67, 161, 255,
-    70, 24, 250, 164, 39, 121, 155, 197, 132, 218, 56, 102, 229, 187, 89, 7,
-    219, 133, 103, 57, 186, 228, 6, 88, 25, 71, 165, 251, 120, 38, 196, 154,
-    101, 59, 217, 135, 4, 90, 184, 230, 167, 249, 27, 69, 198, 152, 122, 36,
-    248, 166, 68, 26, 153, 199, 37, 123, 58, 100, 134, 216, 91, 5, 231, 185,
-    140, 210, 48, 110, 237, 179, 81, 15, 78, 16, 242, 172, 47, 113, 147, 205,
-    17, 79, 173, 243, 112, 46, 204, 146, 211, 141, 111, 49, 178, 236, 14, 80,
-    175, 241, 19, 77, 206, 144, 114, 44, 109, 51, 209, 143, 12, 82, 176, 238,
-    50, 108, 142, 208, 83, 13, 239, 177, 240, 174, 76, 18, 145, 207, 45, 115,
-    202, 148, 118, 40, 171, 245, 23, 73, 8, 86, 180, 234, 105, 55, 213, 139,
-    87, 9, 235, 181, 54, 104, 138, 212, 149, 203, 41, 119, 244, 170, 72, 22,
-    233, 183, 85, 11, 136, 214, 52, 106, 43, 117, 151, 201, 74, 20, 246, 168,
-    116, 42, 200, 150, 21, 75, 169, 247, 182, 232, 10, 84, 215, 137, 107, 53
-};
-
-//
-// Compute a Dallas Semiconductor 8 bit CRC. These show up in the ROM
-// and the registers.  (note: this might better be done without to
-// table, it would probably be smaller and certainly fast enough
-// compared to all those delayMicrosecond() calls.  But I got
-// confused, so I use this table from the examples.)
-//
-
-unsigned char OneWireCRC8(const unsigned char *addr, unsigned char len)
-{
-    unsigned char crc = 0;
-
-    while (len--)
-    {
-        crc = dscrc_table[crc ^ *addr++];
-    }
-    return crc;
-}
-#else
-//
-// Compute a Dallas Semiconductor 8 bit CRC directly.
-// this is much slower, but much smaller, than the lookup table.
-//
-
-unsigned char OneWireCRC8(unsigned char *addr, unsigned char len)
-{
-    unsigned char crc = 0;
-
-    while (len--)
-    {
-        unsigned char inbyte = *addr++;
-        for (unsigned char i = 8; i; i--)
-        {
-            unsigned char mix = (crc ^ inbyte) & 0x01;
-            crc >>= 1;
-            if (mix) crc ^= 0x8C;
-            inbyte >>= 1;
-        }
-    }
-    return crc;
-}
-#endif
-
-#if ONEWIRE_CRC16
-
-bool OneWireCheckCRC16(const unsigned char* input, unsigned int len, const unsigned char* inverted_crc, unsigned int crc)
-{
-    crc = ~OneWireCRC16(input, len, crc);
-    return (crc & 0xFF) == inverted_crc[0] && (crc >> 8) == inverted_crc[1];
-}
-
-unsigned int OneWireCRC16(const unsigned char* input, unsigned int len, unsigned int crc)
-{
-    static const unsigned char oddparity[16] = {0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0};
-
-    for (unsigned int i = 0; i < len; i++)
-    {
-        // Even though we're just copying a byte from the input,
-        // we'll be doing 16-bit computation with it.
-        unsigned int cdata = input[i];
-        cdata = (cdata ^ crc) & 0xff;
-        crc >>= 8;
-
-        if (oddparity[cdata & 0x0F] ^ oddparity[cdata >> 4])
-            crc ^= 0xC001;
-
-        cdata <<= 6;
-        crc ^= cdata;
-        cdata <<= 1;
-        crc ^= cdata;
-    }
-    return crc;
-}
-#endif
-
-#endif
-
@@ -20,9 +20,9 @@
 // and -ffunction-sections when compiling, and Wl,--gc-sections
 // when linking), so most of these will not result in any code size
 // reduction.  Well, unless you try to use the missing features
-// and redesign your program to not need them!  ONEWIRE_CRC8_TABLE
+// and redesign your program to not need them!  ONEWIRE_CRC_METHOD
 // is the exception, because it selects a fast but large algorithm
-// or a small but slow algorithm.
+// or a small but slow algorithm, see OneWireCRC.h.
 
 // you can exclude onewire_search by defining that to 0
 #ifndef ONEWIRE_SEARCH
@@ -34,19 +34,14 @@
 #define ONEWIRE_CRC 1
 #endif
 
-// Select the table-lookup method of computing the 8-bit CRC
-// by setting this to 1.  The lookup table enlarges code size by
-// about 250 bytes.  It does NOT consume RAM (but did in very
-// old versions of OneWire).  If you disable this, a slower
-// but very compact algorithm is used.
-#ifndef ONEWIRE_CRC8_TABLE
-#define ONEWIRE_CRC8_TABLE 0
-#endif
+// The CRC functions are in Common/OneWireCRC.c, the method (bitwise, nibble
+// table, byte table or slice-by-4) is selected with ONEWIRE_CRC_METHOD.
+// ONEWIRE_CRC8_TABLE set to 1 still selects the byte table.
 
-// You can allow 16-bit CRC checks by defining this to 1
-// (Note that ONEWIRE_CRC must also be 1.)
-#ifndef ONEWIRE_CRC16
-#define ONEWIRE_CRC16 0
+// Instruction cycles per microsecond (Fosc/4), used by the overdrive slots
+// which are too short for the timer.
+#ifndef ONEWIRE_CYCLES_PER_US
+#define ONEWIRE_CYCLES_PER_US 8
 #endif
 
 #define FALSE 0
@@ -81,6 +76,21 @@
  */
 #define RECALL_E_E              0xB8
 
+/**
+ * Overdrive Skip ROM Command, the devices that support it go to overdrive.
+ */
+#define OVERDRIVE_SKIP_ROM_COMMAND      0x3C
+
+/**
+ * Overdrive Match ROM Command, the ROM code is sent at overdrive speed.
+ */
+#define OVERDRIVE_MATCH_ROM_COMMAND     0x69
+
+/** Standard speed, about 15 kbps*/
+#define ONEWIRE_SPEED_STANDARD  0
+/** Overdrive speed, about 110 kbps*/
+#define ONEWIRE_SPEED_OVERDRIVE 1
+
 #if ONEWIRE_SEARCH
 // global search state
 volatile unsigned char ROM_NO[8];
@@ -124,6 +134,18 @@ void OneWireSelect(tLaseredROMCode *device);
 // Issue a 1-Wire rom skip command, to address all on bus.
 void OneWireSkip(void);
 
+// Set the speed of the slots of the master. A standard speed reset puts all
+// the devices back to standard speed.
+void OneWireSpeed(unsigned char speed);
+
+// Put the devices that support it in overdrive, with a standard speed reset.
+// Returns 1 if a device responds with a presence pulse.
+unsigned char OneWireOverdriveSkip(void);
+
+// Put one device in overdrive and select it, with a standard speed reset.
+// Returns 1 if a device responds with a presence pulse.
+unsigned char OneWireOverdriveMatch(tLaseredROMCode *device);
+
 // Write a byte. If 'power' is one then the wire is held high at
 // the end for parasitically powered devices. You are responsible
 // for eventually depowering it by calling depower() or doing
@@ -159,52 +181,14 @@ void OneWireTargetSearch(unsigned char family_code);
 // get garbage.  The order is deterministic. You will always get
 // the same devices in the same order.
 unsigned char OneWireSearch(void);
+unsigned char OneWireAlarmSearch(void);
+unsigned char OneWireVerify(tLaseredROMCode *device);
 void OneWireFindAllDevicesOnBus(tLaseredROMCode *romcode, unsigned char *num_devices);
 
 #endif
 
 #if ONEWIRE_CRC
-// Compute a Dallas Semiconductor 8 bit CRC, these are used in the
-// ROM and scratchpad registers.
-unsigned char OneWireCRC8(unsigned char *addr, unsigned char len);
-
-#if ONEWIRE_CRC16
-// Compute the 1-Wire CRC16 and compare it against the received CRC.
-// Example usage (reading a DS2408):
-//    // Put everything in a buffer so we can compute the CRC easily.
-//    unsigned char buf[13];
-//    buf[0] = 0xF0;    // Read PIO Registers
-//    buf[1] = 0x88;    // LSB address
-//    buf[2] = 0x00;    // MSB address
-//    WriteBytes(net, buf, 3);    // Write 3 cmd bytes
-//    ReadBytes(net, buf+3, 10);  // Read 6 data bytes, 2 0xFF, 2 CRC16
-//    if (!CheckCRC16(buf, 11, &buf[11])) {
-//        // Handle error.
-//    }     
-//          
-// @param input - Array of bytes to checksum.
-// @param len - How many bytes to use.
-// @param inverted_crc - The two CRC16 bytes in the received data.
-//                       This should just point into the received data,
-//                       *not* at a 16-bit integer.
-// @param crc - The crc starting value (optional)
-// @return True, iff the CRC matches.
-bool OneWireCheckCRC16(const unsigned char* input, unsigned int len, const unsigned char* inverted_crc, unsigned int crc);
-
-// Compute a Dallas Semiconductor 16 bit CRC.  This is required to check
-// the integrity of data received from many 1-Wire devices.  Note that the
-// CRC computed here is *not* what you'll get from the 1-Wire network,
-// for two reasons:
-//   1) The CRC is transmitted bitwise inverted.
-//   2) Depending on the endian-ness of your processor, the binary
-//      representation of the two-byte return value may have a different
-//      byte order than the two bytes you get from 1-Wire.
-// @param input - Array of bytes to checksum.
-// @param len - How many bytes to use.
-// @param crc - The crc starting value (optional)
-// @return The CRC16, as defined by Dallas Semiconductor.
-unsigned int OneWireCRC16(const unsigned char* input, unsigned int len, unsigned int crc);
-#endif
+#include "OneWireCRC.h"
 #endif
 void delayMicroseconds(unsigned int uSec);
 #endif
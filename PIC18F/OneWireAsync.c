@@ -0,0 +1,352 @@
+/**
+ *  @file       OneWireAsync.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       June 2013
+ *  @brief      Timer driven 1-Wire master transactions.
+ *
+ *  Copyright (C) 2013  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "OneWireAsync.h"
+
+/**Timings in microseconds, the same of OneWireReset, OneWireWriteBit and
+ OneWireReadBit.*/
+#define RESET_LOW                   480
+#define RESET_SAMPLE                70
+#define RESET_END                   410
+#define WRITE_ONE_LOW               10
+#define WRITE_ZERO_LOW              65
+#define WRITE_SLOT                  65
+#define RECOVERY                    5
+#define READ_LOW                    3
+#define READ_SAMPLE                 13
+#define READ_SLOT                   66
+
+/**Phases of a transaction, each one ends with a timer interrupt.*/
+enum
+{
+    ONEWIRE_STATE_IDLE,
+    ONEWIRE_STATE_RESET_LOW,
+    ONEWIRE_STATE_RESET_SAMPLE,
+    ONEWIRE_STATE_RESET_END,
+    ONEWIRE_STATE_ZERO_LOW,
+    ONEWIRE_STATE_SLOT
+};
+
+/**Transaction on the bus, the head of the queue*/
+static tOneWireTransaction *volatile pHead = NULL;
+/**Last transaction of the queue*/
+static tOneWireTransaction *pTail = NULL;
+/**Phase of the transaction on the bus*/
+static volatile unsigned char state = ONEWIRE_STATE_IDLE;
+/**Bytes of the transaction already transfered*/
+static unsigned char count;
+/**Byte being written or read*/
+static unsigned char shift;
+/**Bit of the byte on the bus, 0 before the first bit*/
+static unsigned char bitMask;
+/**Low byte of the timer when the slot started*/
+static unsigned char timerStart;
+
+/**
+ * Starts the timer, its interrupt comes at the end of the period.
+ * @param microseconds Period of the timer.
+ */
+static void OneWireAsyncTimer(unsigned int microseconds)
+{
+    timerStart = (unsigned char) (0xFFFF - microseconds);
+    ONEWIREASYNC_TIMER_START(microseconds);
+}
+
+/**
+ * Waits inside the interrupt until some microseconds after the start of the
+ * timer, for the short phases of the slots.
+ * @param microseconds Time since the start of the timer (less than 256).
+ */
+static void OneWireAsyncWait(unsigned char microseconds)
+{
+    while ((unsigned char) (ONEWIREASYNC_TIMER_LOW() - timerStart)
+            < microseconds);
+}
+
+/**
+ * Initiates the queue and the timer.
+ */
+void OneWireAsyncInit(void)
+{
+    pHead = NULL;
+    pTail = NULL;
+    state = ONEWIRE_STATE_IDLE;
+    ONEWIREASYNC_TIMER_INIT();
+    ONEWIREASYNC_INTERRUPT_ON();
+}
+
+static void OneWireAsyncStartNext(void);
+
+/**
+ * Ends the transaction on the bus and starts the next one.
+ * @param status Status of the transaction.
+ */
+static void OneWireAsyncEnd(tOneWireStatus status)
+{
+    tOneWireTransaction *pTransaction = pHead;
+
+    ONEWIREASYNC_TIMER_STOP();
+    pHead = pTransaction->pNext;
+    pTransaction->status = status;
+    state = ONEWIRE_STATE_IDLE;
+
+    if (pTransaction->callback != NULL)
+    {
+        pTransaction->callback(pTransaction);
+    }
+
+    //the callback may have submitted another transaction
+    if (state == ONEWIRE_STATE_IDLE)
+    {
+        OneWireAsyncStartNext();
+    }
+}
+
+/**
+ * Starts the next slot of the transaction on the bus, or ends it.
+ */
+static void OneWireAsyncNextSlot(void)
+{
+    tOneWireTransaction *pTransaction = pHead;
+
+    if (bitMask == 0)
+    {
+        if (count < pTransaction->writeLength)
+        {
+            shift = pTransaction->write[count];
+        }
+        else if (count < pTransaction->writeLength + pTransaction->readLength)
+        {
+            shift = 0;
+        }
+        else
+        {
+            OneWireAsyncEnd(ONEWIRE_TRANSACTION_DONE);
+            return;
+        }
+
+        bitMask = 0x01;
+    }
+
+    if (count < pTransaction->writeLength)
+    {
+        if (shift & bitMask)
+        {
+            OneWireAsyncTimer(WRITE_SLOT);
+            ONEWIREASYNC_LOW();
+            OneWireAsyncWait(WRITE_ONE_LOW);
+            ONEWIREASYNC_RELEASE();
+            state = ONEWIRE_STATE_SLOT;
+        }
+        else
+        {
+            OneWireAsyncTimer(WRITE_ZERO_LOW);
+            ONEWIREASYNC_LOW();
+            state = ONEWIRE_STATE_ZERO_LOW;
+        }
+    }
+    else
+    {
+        OneWireAsyncTimer(READ_SLOT);
+        ONEWIREASYNC_LOW();
+        OneWireAsyncWait(READ_LOW);
+        ONEWIREASYNC_RELEASE();
+        OneWireAsyncWait(READ_SAMPLE);
+
+        if (ONEWIREASYNC_READ())
+        {
+            shift |= bitMask;
+        }
+
+        state = ONEWIRE_STATE_SLOT;
+    }
+
+    bitMask <<= 1;
+
+    if (bitMask == 0)
+    {
+        if (count >= pTransaction->writeLength)
+        {
+            pTransaction->read[count - pTransaction->writeLength] = shift;
+        }
+
+        count++;
+    }
+}
+
+/**
+ * Starts the transaction at the head of the queue.
+ */
+static void OneWireAsyncStartNext(void)
+{
+    if (pHead == NULL)
+    {
+        state = ONEWIRE_STATE_IDLE;
+        return;
+    }
+
+    pHead->status = ONEWIRE_TRANSACTION_RUNNING;
+    count = 0;
+    bitMask = 0;
+
+    if (pHead->reset)
+    {
+        state = ONEWIRE_STATE_RESET_LOW;
+        OneWireAsyncTimer(RESET_LOW);
+        ONEWIREASYNC_LOW();
+    }
+    else
+    {
+        OneWireAsyncNextSlot();
+    }
+}
+
+/**
+ * Adds a transaction to the queue, it starts at once if the bus is free.
+ * @param pTransaction Transaction, filled by the caller.
+ * @return false if the transaction is already on the queue.
+ */
+bool OneWireAsyncSubmit(tOneWireTransaction *pTransaction)
+{
+    if ((pTransaction->status == ONEWIRE_TRANSACTION_QUEUED)
+            || (pTransaction->status == ONEWIRE_TRANSACTION_RUNNING))
+    {
+        return false;
+    }
+
+    pTransaction->status = ONEWIRE_TRANSACTION_QUEUED;
+    pTransaction->pNext = NULL;
+
+    ONEWIREASYNC_INTERRUPT_OFF();
+
+    if (pHead == NULL)
+    {
+        pHead = pTransaction;
+        pTail = pTransaction;
+        OneWireAsyncStartNext();
+    }
+    else
+    {
+        pTail->pNext = pTransaction;
+        pTail = pTransaction;
+    }
+
+    ONEWIREASYNC_INTERRUPT_ON();
+
+    return true;
+}
+
+/**
+ * Fills and submits a transaction.
+ * @param pTransaction Transaction, it has to stay alive until the callback.
+ * @param reset Starts with a reset.
+ * @param write Bytes to write, read by the interrupt (don't reuse them before
+ *              the callback).
+ * @param writeLength Number of bytes to write.
+ * @param read Buffer for the bytes read after the write.
+ * @param readLength Number of bytes to read.
+ * @param callback Called from the interrupt at the end, can be NULL.
+ * @return false if the transaction is already on the queue.
+ */
+bool OneWireAsyncTransfer(tOneWireTransaction *pTransaction, bool reset,
+                          const unsigned char *write, unsigned char writeLength,
+                          unsigned char *read, unsigned char readLength,
+                          tOneWireCallback callback)
+{
+    if ((pTransaction->status == ONEWIRE_TRANSACTION_QUEUED)
+            || (pTransaction->status == ONEWIRE_TRANSACTION_RUNNING))
+    {
+        return false;
+    }
+
+    pTransaction->reset = reset;
+    pTransaction->write = write;
+    pTransaction->writeLength = writeLength;
+    pTransaction->read = read;
+    pTransaction->readLength = readLength;
+    pTransaction->callback = callback;
+
+    return OneWireAsyncSubmit(pTransaction);
+}
+
+/**
+ * Checks if all the transactions ended.
+ * @return true if the queue is empty.
+ */
+bool OneWireAsyncIsIdle(void)
+{
+    return state == ONEWIRE_STATE_IDLE;
+}
+
+/**
+ * State machine of the transactions, to be called from the interrupt routine
+ * when the timer flag is set.
+ */
+void OneWireAsyncInterruptHandler(void)
+{
+    tOneWireTransaction *pTransaction = pHead;
+
+    ONEWIREASYNC_TIMER_STOP();
+
+    if (pTransaction == NULL)
+    {
+        state = ONEWIRE_STATE_IDLE;
+        return;
+    }
+
+    switch (state)
+    {
+        case ONEWIRE_STATE_RESET_LOW:
+            ONEWIREASYNC_RELEASE();
+            state = ONEWIRE_STATE_RESET_SAMPLE;
+            OneWireAsyncTimer(RESET_SAMPLE);
+            break;
+
+        case ONEWIRE_STATE_RESET_SAMPLE:
+            if (ONEWIREASYNC_READ())
+            {
+                //no presence pulse
+                OneWireAsyncEnd(ONEWIRE_TRANSACTION_NO_PRESENCE);
+                break;
+            }
+            state = ONEWIRE_STATE_RESET_END;
+            OneWireAsyncTimer(RESET_END);
+            break;
+
+        case ONEWIRE_STATE_ZERO_LOW:
+            ONEWIREASYNC_RELEASE();
+            state = ONEWIRE_STATE_SLOT;
+            OneWireAsyncTimer(RECOVERY);
+            break;
+
+        case ONEWIRE_STATE_RESET_END:
+        case ONEWIRE_STATE_SLOT:
+            OneWireAsyncNextSlot();
+            break;
+
+        default:
+            state = ONEWIRE_STATE_IDLE;
+            break;
+    }
+}
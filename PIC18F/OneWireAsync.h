@@ -0,0 +1,141 @@
+/**
+ *  @file       OneWireAsync.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       June 2013
+ *  @brief      Timer driven 1-Wire master transactions.
+ *
+ *  Copyright (C) 2013  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  A transaction is an optional reset, bytes to write and bytes to read, e.g.
+ *  match ROM + read scratchpad. The transactions are queued and the Timer 3
+ *  interrupt runs the slots: each slot starts the timer for its whole length,
+ *  the few microseconds of the low pulse and of the sample point are waited
+ *  inside the interrupt, the rest of the slot (and all of the reset) runs in
+ *  the background. Call OneWireAsyncInterruptHandler() from the HIGH priority
+ *  interrupt routine, so the sample point is not delayed:
+ *  @code
+ *  if (PIR2bits.TMR3IF)
+ *  {
+ *      OneWireAsyncInterruptHandler();
+ *  }
+ *  @endcode
+ *  The callback runs inside the interrupt, keep it short (e.g. uKernelPostEvent
+ *  or uKernelDefer). The blocking OneWire functions use the same timer, don't
+ *  call them while a transaction is running.
+ *  Built with ONEWIREASYNC_HOST the pin and the timer are replaced by the bus
+ *  simulator of Common/KernelHost/OneWireBusSim.h, to test it on Linux.
+ */
+
+#ifndef _ONEWIREASYNC_H_
+#define _ONEWIREASYNC_H_
+
+#include <stdbool.h>
+
+#ifdef ONEWIREASYNC_HOST
+#include "../Common/KernelHost/OneWireBusSim.h"
+
+#define ONEWIREASYNC_LOW()              OneWireBusSimLow()
+#define ONEWIREASYNC_RELEASE()          OneWireBusSimRelease()
+#define ONEWIREASYNC_READ()             OneWireBusSimRead()
+#define ONEWIREASYNC_TIMER_START(us)    OneWireBusSimTimerStart(us)
+#define ONEWIREASYNC_TIMER_LOW()        OneWireBusSimTimerLow()
+#define ONEWIREASYNC_TIMER_STOP()
+#define ONEWIREASYNC_INTERRUPT_ON()
+#define ONEWIREASYNC_INTERRUPT_OFF()
+#define ONEWIREASYNC_TIMER_INIT()
+#else
+#include "OneWire.h"
+
+#define ONEWIREASYNC_LOW()              (ONEWIRE_PIN_WRITE = LOW,            \
+                                         ONEWIRE_PIN_DIRECTION = OUTPUT)
+#define ONEWIREASYNC_RELEASE()          (ONEWIRE_PIN_DIRECTION = INPUT)
+#define ONEWIREASYNC_READ()             (ONEWIRE_PIN_READ)
+/**Timer 3 counts 1 us, the interrupt comes after us microseconds.*/
+#define ONEWIREASYNC_TIMER_START(us)    (T3CONbits.TMR3ON = 0,              \
+                                         TMR3H = (unsigned char)            \
+                                                 ((0xFFFF - (us)) >> 8),    \
+                                         TMR3L = (unsigned char)            \
+                                                 (0xFFFF - (us)),           \
+                                         PIR2bits.TMR3IF = 0,               \
+                                         T3CONbits.TMR3ON = 1)
+#define ONEWIREASYNC_TIMER_LOW()        (TMR3L)
+#define ONEWIREASYNC_TIMER_STOP()       (T3CONbits.TMR3ON = 0,              \
+                                         PIR2bits.TMR3IF = 0)
+#define ONEWIREASYNC_INTERRUPT_ON()     (PIE2bits.TMR3IE = 1)
+#define ONEWIREASYNC_INTERRUPT_OFF()    (PIE2bits.TMR3IE = 0)
+#define ONEWIREASYNC_TIMER_INIT()       (OneWireInit(), IPR2bits.TMR3IP = 1)
+#endif
+
+/**
+ * @enum tOneWireStatus
+ * @brief Status of a transaction.
+ */
+typedef enum
+{
+    /** The transaction was never submitted or the callback already ran.*/
+    ONEWIRE_TRANSACTION_IDLE,
+    /** Waiting on the queue.*/
+    ONEWIRE_TRANSACTION_QUEUED,
+    /** On the bus.*/
+    ONEWIRE_TRANSACTION_RUNNING,
+    /** All the bytes were transfered.*/
+    ONEWIRE_TRANSACTION_DONE,
+    /** No device answered the reset.*/
+    ONEWIRE_TRANSACTION_NO_PRESENCE
+} tOneWireStatus;
+
+struct _tOneWireTransaction;
+
+/**Called from the interrupt when a transaction ends.*/
+typedef void (*tOneWireCallback)(struct _tOneWireTransaction *pTransaction);
+
+/**
+ * @struct _tOneWireTransaction
+ * @brief Transaction on the bus, it has to stay alive until its callback.
+ */
+typedef struct _tOneWireTransaction
+{
+    /** Starts with a reset and checks the presence pulse*/
+    bool reset;
+    /** Bytes to write, e.g. the ROM and function commands*/
+    const unsigned char *write;
+    /** Number of bytes to write*/
+    unsigned char writeLength;
+    /** Buffer for the bytes read after the write*/
+    unsigned char *read;
+    /** Number of bytes to read*/
+    unsigned char readLength;
+    /** Called when the transaction ends, can be NULL*/
+    tOneWireCallback callback;
+    /** Free for the caller, e.g. the uKernel task to be posted*/
+    void *context;
+    /** Status, set by the driver*/
+    volatile tOneWireStatus status;
+    /** Next transaction on the queue*/
+    struct _tOneWireTransaction *pNext;
+} tOneWireTransaction;
+
+void OneWireAsyncInit(void);
+bool OneWireAsyncSubmit(tOneWireTransaction *pTransaction);
+bool OneWireAsyncTransfer(tOneWireTransaction *pTransaction, bool reset,
+                          const unsigned char *write, unsigned char writeLength,
+                          unsigned char *read, unsigned char readLength,
+                          tOneWireCallback callback);
+bool OneWireAsyncIsIdle(void);
+void OneWireAsyncInterruptHandler(void);
+
+#endif /* _ONEWIREASYNC_H_ */
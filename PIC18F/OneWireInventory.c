@@ -0,0 +1,198 @@
+/**
+ *  @file       OneWireInventory.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       June 2013
+ *  @brief      List of the devices of a 1-Wire bus kept between boots.
+ *
+ *  Copyright (C) 2013  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "OneWireInventory.h"
+
+/**
+ * Checks the CRC of a ROM code.
+ * @param device ROM code.
+ * @return true if the CRC is right.
+ */
+static bool OneWireInventoryCheckROM(tLaseredROMCode *device)
+{
+    return (device->FamilyCode != 0)
+            && (device->OWICRC == OneWireCRC8(device->Array, 7));
+}
+
+/**
+ * Loads the stored table and checks the bus with an alarm search, the bus is
+ * enumerated only if the table is not valid or a new device is found.
+ * @param pInventory Inventory, with the table and the hooks set.
+ * @return Number of devices.
+ */
+unsigned char OneWireInventoryInit(tOneWireInventory *pInventory)
+{
+    unsigned char i;
+
+    pInventory->number = 0;
+
+    if ((pInventory->load == NULL)
+            || !pInventory->load(pInventory->devices, &pInventory->number,
+                                 pInventory->size)
+            || (pInventory->number > pInventory->size))
+    {
+        return OneWireInventoryEnumerate(pInventory);
+    }
+
+    for (i = 0; i < pInventory->number; i++)
+    {
+        if (!OneWireInventoryCheckROM(&pInventory->devices[i]))
+            return OneWireInventoryEnumerate(pInventory);
+    }
+
+    OneWireInventoryCheckNew(pInventory);
+
+    return pInventory->number;
+}
+
+/**
+ * Searches all the devices of the bus and saves the table if it changed.
+ * @param pInventory Inventory.
+ * @return Number of devices, no more than the size of the table.
+ */
+unsigned char OneWireInventoryEnumerate(tOneWireInventory *pInventory)
+{
+    tLaseredROMCode device;
+    unsigned char number = 0;
+    bool changed = false;
+    unsigned char i;
+
+    OneWireResetSearch();
+
+    while ((number < pInventory->size) && OneWireSearch())
+    {
+        for (i = 0; i < 8; i++)
+            device.Array[i] = ROM_NO[i];
+
+        if (!OneWireInventoryCheckROM(&device))
+            continue;
+
+        if ((number >= pInventory->number)
+                || (memcmp(pInventory->devices[number].Array, device.Array, 8)
+                    != 0))
+        {
+            pInventory->devices[number] = device;
+            changed = true;
+        }
+
+        number++;
+    }
+
+    if (number != pInventory->number)
+        changed = true;
+
+    pInventory->number = number;
+
+    if (changed && (pInventory->save != NULL))
+        pInventory->save(pInventory->devices, number);
+
+    return number;
+}
+
+/**
+ * Looks for a ROM code in the table.
+ * @param pInventory Inventory.
+ * @param rom ROM code, 8 bytes.
+ * @return Index of the device or ONEWIRE_INVENTORY_NOT_FOUND.
+ */
+unsigned char OneWireInventoryFind(tOneWireInventory *pInventory,
+                                   const unsigned char *rom)
+{
+    unsigned char i;
+
+    for (i = 0; i < pInventory->number; i++)
+    {
+        if (memcmp(pInventory->devices[i].Array, rom, 8) == 0)
+            return i;
+    }
+
+    return ONEWIRE_INVENTORY_NOT_FOUND;
+}
+
+/**
+ * Checks that a device of the table is still on the bus, e.g. after a failed
+ * read, and enumerates the bus again if it is not.
+ * @param pInventory Inventory.
+ * @param index Index of the device.
+ * @return true if the device answered, false if the table was rebuilt (the
+ *         indexes may have changed).
+ */
+bool OneWireInventoryVerify(tOneWireInventory *pInventory, unsigned char index)
+{
+    if ((index < pInventory->number)
+            && OneWireVerify(&pInventory->devices[index]))
+    {
+        return true;
+    }
+
+    OneWireInventoryEnumerate(pInventory);
+
+    return false;
+}
+
+/**
+ * Checks all the devices of the table, one targeted search pass each. It
+ * costs about the same bus time as an enumeration, so it is meant for a full
+ * check and not for every boot.
+ * @param pInventory Inventory.
+ * @return true if all the devices answered, false if the table was rebuilt.
+ */
+bool OneWireInventoryVerifyAll(tOneWireInventory *pInventory)
+{
+    unsigned char i;
+
+    for (i = 0; i < pInventory->number; i++)
+    {
+        if (!OneWireVerify(&pInventory->devices[i]))
+        {
+            OneWireInventoryEnumerate(pInventory);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Runs an alarm search and enumerates the bus if a device in alarm is not in
+ * the table. Only the devices in alarm take a search pass.
+ * @param pInventory Inventory.
+ * @return true if a new device was found.
+ */
+bool OneWireInventoryCheckNew(tOneWireInventory *pInventory)
+{
+    OneWireResetSearch();
+
+    while (OneWireAlarmSearch())
+    {
+        if (OneWireInventoryFind(pInventory, (const unsigned char *) ROM_NO)
+                == ONEWIRE_INVENTORY_NOT_FOUND)
+        {
+            OneWireInventoryEnumerate(pInventory);
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,91 @@
+/**
+ *  @file       OneWireInventory.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       June 2013
+ *  @brief      List of the devices of a 1-Wire bus kept between boots.
+ *
+ *  Copyright (C) 2013  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  OneWireFindAllDevicesOnBus costs a whole search pass per device every boot.
+ *  The inventory keeps the table of ROM codes in EEPROM or flash through the
+ *  load and save hooks and only enumerates the bus again when it has to: the
+ *  stored table is missing or corrupt, a device of the table does not answer
+ *  OneWireInventoryVerify, or the alarm search finds a device that is not in
+ *  the table. With no device in alarm the boot check is a reset, the command
+ *  and two read slots, whatever the number of devices.
+ *  @code
+ *  bool InventoryLoad(tLaseredROMCode *devices, unsigned char *number,
+ *                     unsigned char size);
+ *  void InventorySave(const tLaseredROMCode *devices, unsigned char number);
+ *
+ *  tLaseredROMCode sensors[30];
+ *  tOneWireInventory inventory = {sensors, 30, 0, InventoryLoad, InventorySave};
+ *
+ *  OneWireInventoryInit(&inventory);
+ *  ...
+ *  if (!DS18B20GetTemperature(&sensors[i], &temperature))
+ *      OneWireInventoryVerify(&inventory, i);
+ *  @endcode
+ */
+
+#ifndef _ONEWIREINVENTORY_H_
+#define _ONEWIREINVENTORY_H_
+
+#include <stdbool.h>
+#include "OneWire.h"
+
+/**Index returned by OneWireInventoryFind for an unknown device.*/
+#define ONEWIRE_INVENTORY_NOT_FOUND     0xFF
+
+/**
+ * Reads the stored table.
+ * @return false if there is no valid table.
+ */
+typedef bool (*tOneWireInventoryLoad)(tLaseredROMCode *devices,
+                                      unsigned char *number,
+                                      unsigned char size);
+/**Writes the table, only called when it changed.*/
+typedef void (*tOneWireInventorySave)(const tLaseredROMCode *devices,
+                                      unsigned char number);
+
+/**
+ * @struct tOneWireInventory
+ * @brief Devices of the bus and the hooks to keep them.
+ */
+typedef struct
+{
+    /** Table of the devices, in the order of the search*/
+    tLaseredROMCode *devices;
+    /** Size of the table*/
+    unsigned char size;
+    /** Number of devices in the table*/
+    unsigned char number;
+    /** Reads the stored table, can be NULL*/
+    tOneWireInventoryLoad load;
+    /** Stores the table, can be NULL*/
+    tOneWireInventorySave save;
+} tOneWireInventory;
+
+unsigned char OneWireInventoryInit(tOneWireInventory *pInventory);
+unsigned char OneWireInventoryEnumerate(tOneWireInventory *pInventory);
+unsigned char OneWireInventoryFind(tOneWireInventory *pInventory,
+                                   const unsigned char *rom);
+bool OneWireInventoryVerify(tOneWireInventory *pInventory, unsigned char index);
+bool OneWireInventoryVerifyAll(tOneWireInventory *pInventory);
+bool OneWireInventoryCheckNew(tOneWireInventory *pInventory);
+
+#endif /* _ONEWIREINVENTORY_H_ */
@@ -23,6 +23,15 @@
 #include <p18cxxx.h>
 #include "USARTDevice.h"
 
+static unsigned char txBuffer[USART_TX_BUFFER_SIZE];
+static unsigned char rxBuffer[USART_RX_BUFFER_SIZE];
+/**Bytes waiting to be sent, emptied by the interrupt*/
+static tFIFO txFIFO;
+/**Bytes received, filled by the interrupt*/
+static tFIFO rxFIFO;
+/**Called when a line terminator is received*/
+static tUSARTLineCallback lineCallback = 0;
+
 void USARTInit(void)
 {
     unsigned int baud = 0;
@@ -131,4 +140,159 @@ void USARTSendROMString(const char *string)
         if (c != 0) USARTPutChar(c);
     }
     while (c != 0);
-}
\ No newline at end of file
+}
+
+/**
+ * Starts the buffered reception and transmission. USARTInit has to be called
+ * before, and the peripheral interrupts enabled.
+ * @param callback Called from the interrupt when USART_LINE_TERMINATOR is
+ *                 received, keep it short (e.g. uKernelPostEvent). Can be 0.
+ */
+void USARTBufferedInit(tUSARTLineCallback callback)
+{
+    USART_RX_INTERRUPT = 0;
+    USART_TX_INTERRUPT = 0;
+
+    uFIFOInit(&txFIFO, txBuffer, USART_TX_BUFFER_SIZE);
+    uFIFOInit(&rxFIFO, rxBuffer, USART_RX_BUFFER_SIZE);
+    lineCallback = callback;
+
+    USART_RX_INTERRUPT = 1;
+}
+
+/**
+ * Queues bytes to be sent, without waiting.
+ * @param buffer Bytes to send, copied to the ring.
+ * @param length Number of bytes.
+ * @return Number of bytes queued, less than length if the ring is full.
+ */
+unsigned int USARTWrite(const char *buffer, unsigned int length)
+{
+    unsigned int written;
+    unsigned int space;
+
+    //the indexes of the ring are not atomic on the PIC18
+    USART_TX_INTERRUPT = 0;
+
+    //the ring takes UFIFO_INDEX lengths, never more than its free space
+    space = uFIFOSpaceFree(&txFIFO);
+    if (length > space)
+    {
+        length = space;
+    }
+    written = uFIFOPut(&txFIFO, (unsigned char *) buffer,
+                       (UFIFO_INDEX) length);
+
+    //the flag is set while TXREG is empty, so this starts the transmission
+    if (!uFIFOisEmpty(&txFIFO))
+    {
+        USART_TX_INTERRUPT = 1;
+    }
+
+    return written;
+}
+
+/**
+ * Queues a string to be sent, without waiting.
+ * @param string String to send.
+ * @return Number of bytes queued.
+ */
+unsigned int USARTWriteString(const char *string)
+{
+    unsigned int length = 0;
+
+    while (string[length] != 0)
+    {
+        length++;
+    }
+
+    return USARTWrite(string, length);
+}
+
+/**
+ * Takes the bytes already received, without waiting.
+ * @param buffer Buffer for the bytes.
+ * @param length Size of the buffer.
+ * @return Number of bytes read, 0 if none was received.
+ */
+unsigned int USARTRead(char *buffer, unsigned int length)
+{
+    unsigned int read;
+    unsigned int available;
+
+    USART_RX_INTERRUPT = 0;
+
+    //the ring takes UFIFO_INDEX lengths, never more than it holds
+    available = uFIFOSpaceOcupied(&rxFIFO);
+    if (length > available)
+    {
+        length = available;
+    }
+    read = uFIFOGet(&rxFIFO, (unsigned char *) buffer, (UFIFO_INDEX) length);
+    USART_RX_INTERRUPT = 1;
+
+    return read;
+}
+
+/**
+ * Number of bytes received and not read yet.
+ * @return Number of bytes on the reception ring.
+ */
+unsigned int USARTAvailable(void)
+{
+    unsigned int available;
+
+    USART_RX_INTERRUPT = 0;
+    available = uFIFOSpaceOcupied(&rxFIFO);
+    USART_RX_INTERRUPT = 1;
+
+    return available;
+}
+
+/**
+ * Checks if there are bytes still to be sent.
+ * @return true until the last byte leaves the shift register.
+ */
+bool USARTIsSending(void)
+{
+    return USART_TX_INTERRUPT || !USART_TXSTATbits.TRMT;
+}
+
+/**
+ * Moves one byte between the hardware and the rings, to be called from the
+ * interrupt routine when the reception or transmission flag is set.
+ */
+void USARTInterruptHandler(void)
+{
+    unsigned char c;
+
+    if (USART_RX_FLAG)
+    {
+        //an overrun stops the reception until CREN is cleared
+        if (USART_RCSTATbits.OERR)
+        {
+            USART_RCSTATbits.CREN = 0;
+            USART_RCSTATbits.CREN = 1;
+        }
+
+        c = USART_RX_REG;
+        uFIFOPut(&rxFIFO, &c, 1);
+
+        if ((c == USART_LINE_TERMINATOR) && (lineCallback != 0))
+        {
+            lineCallback();
+        }
+    }
+
+    if (USART_TX_INTERRUPT && USART_TX_FLAG)
+    {
+        if (uFIFOGet(&txFIFO, &c, 1))
+        {
+            USART_TX_REG = c;
+        }
+        else
+        {
+            USART_TX_INTERRUPT = 0;
+        }
+    }
+}
@@ -19,12 +19,25 @@
  *
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  USARTPutChar and USARTGetChar wait on the hardware. The buffered functions
+ *  (USARTBufferedInit, USARTWrite, USARTRead) copy to and from two uFIFO rings
+ *  and return at once, the bytes are moved by the USART interrupts. Call
+ *  USARTInterruptHandler() from the interrupt routine:
+ *  @code
+ *  if (USART_RX_FLAG || (USART_TX_INTERRUPT && USART_TX_FLAG))
+ *  {
+ *      USARTInterruptHandler();
+ *  }
+ *  @endcode
+ *  Don't mix both sets of functions on the same USART.
  */
 
 #ifndef USARTDEVICE_H
 #define	USARTDEVICE_H
 
 #include <p18cxxx.h>
+#include "uFIFO.h"
 
 #define BAUDRATE                115200
 #define USART_FOSC              64000000
@@ -38,7 +51,25 @@
 #define USART_TX_REG            TXREG1
 #define USART_RX_FLAG           PIR1bits.RC1IF
 #define USART_TX_FLAG           PIR1bits.TX1IF
+#define USART_RX_INTERRUPT      PIE1bits.RC1IE
+#define USART_TX_INTERRUPT      PIE1bits.TX1IE
+
+/**Size of the transmission ring of the buffered functions (one byte is kept
+ free).*/
+#ifndef USART_TX_BUFFER_SIZE
+#define USART_TX_BUFFER_SIZE    128
+#endif
+/**Size of the reception ring of the buffered functions.*/
+#ifndef USART_RX_BUFFER_SIZE
+#define USART_RX_BUFFER_SIZE    64
+#endif
+/**Byte that ends a line for the line callback.*/
+#ifndef USART_LINE_TERMINATOR
+#define USART_LINE_TERMINATOR   '\n'
+#endif
 
+/**Called from the interrupt when a line terminator is received.*/
+typedef void (*tUSARTLineCallback)(void);
 
 void USARTInit(void);
 void USARTSetBaudrate(unsigned long baudrate);
@@ -46,5 +77,13 @@ void USARTPutChar(char c);
 char USARTGetChar(void);
 void USARTSendRAMString(char *string);
 void USARTSendROMString(const char *string);
+
+void USARTBufferedInit(tUSARTLineCallback callback);
+unsigned int USARTWrite(const char *buffer, unsigned int length);
+unsigned int USARTWriteString(const char *string);
+unsigned int USARTRead(char *buffer, unsigned int length);
+unsigned int USARTAvailable(void);
+bool USARTIsSending(void);
+void USARTInterruptHandler(void);
 #endif	/* USARTDEVICE_H */
 
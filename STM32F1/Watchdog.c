@@ -0,0 +1,104 @@
+/**
+ *  @file       Watchdog.c
+ *  @brief      Independent watchdog and stall record for uKernel
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       3 de Maio de 2013
+ *
+ *  Copyright (C) 2013  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Watchdog.h"
+
+/**
+ * Starts the IWDG, once started it can not be stopped.
+ * @param timeout Time without kicks before the reset in milliseconds, up to
+ *                26 s with the LSI at 40 kHz.
+ */
+void WatchdogInit(uint16_t timeout)
+{
+    uint8_t prescaler = IWDG_Prescaler_4;
+    uint32_t reload = (WATCHDOG_LSI_FREQUENCY / 4) * timeout / 1000;
+
+    //each prescaler doubles the division, up to 256
+    while ((reload > 0x0FFF) && (prescaler < IWDG_Prescaler_256))
+    {
+        prescaler++;
+        reload >>= 1;
+    }
+
+    if (reload > 0x0FFF)
+    {
+        reload = 0x0FFF;
+    }
+
+    //the backup domain is written by WatchdogRecordOffender
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_PWR | RCC_APB1Periph_BKP, ENABLE);
+    PWR_BackupAccessCmd(ENABLE);
+
+    IWDG_WriteAccessCmd(IWDG_WriteAccess_Enable);
+    IWDG_SetPrescaler(prescaler);
+    IWDG_SetReload((uint16_t) reload);
+    IWDG_ReloadCounter();
+    IWDG_Enable();
+}
+
+/**
+ * Reloads the IWDG counter.
+ */
+void WatchdogKick(void)
+{
+    IWDG_ReloadCounter();
+}
+
+/**
+ * Keeps the id of the task that stalled, it survives the reset of the IWDG.
+ * It can be called from an interrupt.
+ * @param taskId Id of the task.
+ */
+void WatchdogRecordOffender(uint8_t taskId)
+{
+    BKP_WriteBackupRegister(WATCHDOG_BKP_REGISTER,
+                            WATCHDOG_OFFENDER_MAGIC | taskId);
+}
+
+/**
+ * Checks if the last reset came from the IWDG, to be called at boot before
+ * WatchdogInit. The reset flags and the record are cleared.
+ * @return The id of the task that stalled, 0 if the reset was not caused by a
+ *         stalled task.
+ */
+uint8_t WatchdogGetResetOffender(void)
+{
+    uint16_t record;
+    uint8_t taskId = 0;
+
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_PWR | RCC_APB1Periph_BKP, ENABLE);
+    PWR_BackupAccessCmd(ENABLE);
+
+    record = BKP_ReadBackupRegister(WATCHDOG_BKP_REGISTER);
+
+    if ((RCC_GetFlagStatus(RCC_FLAG_IWDGRST) != RESET)
+            && ((record & 0xFF00) == WATCHDOG_OFFENDER_MAGIC))
+    {
+        taskId = (uint8_t) record;
+    }
+
+    RCC_ClearFlag();
+    BKP_WriteBackupRegister(WATCHDOG_BKP_REGISTER, 0);
+
+    return taskId;
+}
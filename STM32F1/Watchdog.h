@@ -0,0 +1,62 @@
+/**
+ *  @file       Watchdog.h
+ *  @brief      Independent watchdog and stall record for uKernel
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       3 de Maio de 2013
+ *
+ *  Copyright (C) 2013  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  The IWDG is kicked by the uKernel scheduler only while every critical task
+ *  checks in, and the id of the task that stalled is kept on a backup register
+ *  so it can be read after the reset, without a debugger. Build uKernel with:
+ *  @code
+ *  #define UKERNEL_USE_WATCHDOG            1
+ *  #define UKERNEL_WATCHDOG_KICK()         WatchdogKick()
+ *  #define UKERNEL_WATCHDOG_OFFENDER(id)   WatchdogRecordOffender(id)
+ *  @endcode
+ *  and at boot:
+ *  @code
+ *  stalledTask = WatchdogGetResetOffender();
+ *  WatchdogInit(500);
+ *  @endcode
+ *  UKERNEL_WATCHDOG_WINDOW (100 ms by default) has to be shorter than the
+ *  timeout given to WatchdogInit.
+ */
+#ifndef _WATCHDOG_H_
+#define _WATCHDOG_H_
+
+#include <stm32f10x.h>
+
+/**Backup register with the id of the task that stalled.*/
+#ifndef WATCHDOG_BKP_REGISTER
+#define WATCHDOG_BKP_REGISTER       BKP_DR1
+#endif
+
+/**Frequency of the LSI, it can be anything from 30 kHz to 60 kHz.*/
+#ifndef WATCHDOG_LSI_FREQUENCY
+#define WATCHDOG_LSI_FREQUENCY      40000UL
+#endif
+
+/**Marks the backup register as written by WatchdogRecordOffender.*/
+#define WATCHDOG_OFFENDER_MAGIC     0xA500
+
+void WatchdogInit(uint16_t timeout);
+void WatchdogKick(void);
+void WatchdogRecordOffender(uint8_t taskId);
+uint8_t WatchdogGetResetOffender(void);
+
+#endif /* _WATCHDOG_H_ */